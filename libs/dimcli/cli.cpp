@@ -13,12 +13,20 @@
 
 #include <algorithm>
 #include <atomic>
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <exception>
 #include <fstream>
 #include <iostream>
 #include <locale>
+#include <mutex>
+#include <numeric>
 #include <sstream>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <unordered_set>
 
 using namespace std;
 using namespace Dim;
@@ -61,6 +69,12 @@ const auto kDefaultMaxNameColPct = 38.0f;
 // maximum help text line length
 const size_t kDefaultMaxLineWidth = kDefaultConsoleWidth - 1;
 
+// maximum number of choices listed by name in the details of an error
+const size_t kMaxChoicesDetail = 20;
+
+// minimum number of pending values converted by each thread
+const size_t kMinParallelChunk = 4096;
+
 
 /****************************************************************************
 *
@@ -105,12 +119,17 @@ enum NameFlags {
     fNameList      = 0x10, // take args up to next option (non-bool options)
     fNameExcludeNo = 0x20, // don't add --no-* version (long name bools)
     fNameFinal     = 0x40, // is a final option, rest of args are now operands
+    fNameLiteral   = 0x80, // single character name that looks like a modifier
 };
 struct OptName {
     Cli::OptBase * opt;
     unsigned flags;
-    string name;    // name of argument (only for operands)
+    string name;    // name of operand or long option
     int pos;        // used to sort option names in declaration order
+
+    // Interned name, with leading dashes, reported by opt.from() when matched.
+    const string * from = {};
+    size_t slot = {};   // position of opt in the cli's list of options
 };
 
 struct OptKey {
@@ -139,8 +158,7 @@ struct ParseState {
         kFound,     // processing subcommand's arguments
         kUnknown    // processing unknown arguments of subcommand
     } cmdMode = kNone;
-    OptName optName;
-    string name; // Name that was found, includes leading dashes.
+    const OptName * optName = {};
     bool moreOpts = true; // Remaining arguments may contain named options?
     int numOprs = 0; // Number of operands (positional arguments)
     size_t precmdValues = 0;
@@ -149,20 +167,43 @@ struct ParseState {
     // Next value to process, usually within current arg.
     const char * ptr = nullptr;
 
-    // Number of values matched to options, the count is then used to stop the
-    // consumption of following arguments for value lists when the max size of
-    // the vector option is reached.
-    unordered_map<Cli::OptBase *, int> optMatches;
+    // Index of the options of the top level or, once it's been found, of the
+    // subcommand.
+    shared_ptr<const Cli::OptIndex> ndx;
+
+    // Number of values matched to options, by option slot. The count is then
+    // used to stop the consumption of following arguments for value lists
+    // when the max size of the vector option is reached.
+    vector<int> optMatches;
 };
 
 struct RawValue {
     enum Type { kOperand, kOption, kCommand } type;
     Cli::OptBase * opt;
-    string name;
+    const string * name; // interned, see Cli::Config::intern()
     size_t pos;
     const char * ptr;
 };
 
+// Read only view of a whole file mapped into memory, see "Native file
+// mapping API".
+class MappedFile {
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile &) = delete;
+    MappedFile & operator=(const MappedFile &) = delete;
+    ~MappedFile();
+
+    // Returns false if the file couldn't be opened, or isn't a regular file
+    // that can be mapped (such as a pipe).
+    bool open(const string & path);
+    string_view view() const { return {m_base, m_len}; }
+
+private:
+    const char * m_base = {};
+    size_t m_len = 0;
+};
+
 } // namespace
 
 struct Cli::Config {
@@ -176,6 +217,8 @@ struct Cli::Config {
     list<unique_ptr<OptBase>> opts;
     Cli::Opt<bool> * helpOpt = {};
     bool responseFiles = true;
+    bool lazyValues = false;
+    unsigned maxThreads = 0;
     string envOpts;
     istream * conin = &cin;
     ostream * conout = &cout;
@@ -195,6 +238,40 @@ struct Cli::Config {
     float maxNameColPct = kDefaultMaxNameColPct; // as percentage of width
     size_t maxLineWidth = kDefaultMaxLineWidth;
 
+    // Options left as is by the last resetValues().
+    size_t resetsSkipped = 0;
+
+    // Arguments being parsed that the parser owns, and that values may
+    // therefore be moved from.
+    vector<string> * ownedArgs = {};
+
+    // Set while the value being matched was taken directly from the
+    // arguments, so its conversion may be left pending until the end of the
+    // parse.
+    bool allowPending = false;
+
+    // Incremented whenever options or commands are added or changed in ways
+    // that affect how they're indexed. Cached indexes built for an older
+    // generation are discarded.
+    unsigned schemaGen = 0;
+    unsigned ndxGen = 0;
+    unsigned touchedGen = 0;
+    unordered_map<string, shared_ptr<const OptIndex>> parseNdxs;
+    unordered_map<string, shared_ptr<const OptIndex>> helpNdxs;
+
+    // Options by the command they belong to, options for all commands are
+    // listed under kInternalAllCmds and kInternalAllSubcmds. Rebuilt along
+    // with the indexes.
+    unordered_map<string, vector<OptBase *>> cmdOpts;
+
+    // Options with after actions to run when the command is matched, in the
+    // order they were added.
+    unordered_map<string, shared_ptr<const vector<OptBase *>>> afterOpts;
+
+    // Names of the arguments values have been matched with, shared by the
+    // values so they don't each need their own copy.
+    unordered_set<string> names;
+
     static void touchAllCmds(Cli & cli);
     static Config & get(Cli & cli);
     static CommandConfig & findCmdAlways(Cli & cli);
@@ -212,14 +289,48 @@ struct Cli::Config {
     );
     static const GroupConfig & findGrpOrDie(const Cli & cli);
 
+    static shared_ptr<const OptIndex> findIndex(
+        const Cli & cli,
+        const string & cmd,
+        bool forHelpText
+    );
+    static shared_ptr<const vector<OptBase *>> findAfterOpts(
+        const Cli & cli,
+        const string & cmd
+    );
+
+    const string * intern(const string & name);
+    void addOpt(unique_ptr<OptBase> opt);
+
+    // Same as cli.fail() and cli.badUsage(), for when there's no cli.
+    void fail(int code, const string & msg, const string & detail);
+    void badUsage(
+        const string & prefix,
+        const string & value,
+        const string & detail
+    );
+    // Reports the value of an option that failed its deferred conversion.
+    void badDeferred(
+        const OptBase & opt,
+        const ArgMatch & match,
+        const string & value
+    );
+
     Config();
     void updateWidth(size_t width);
+
+    // Discards the cached indexes if options or commands have changed since
+    // they were built.
+    void checkIndexes();
 };
 
 struct Cli::OptIndex {
     vector<OptBase *> m_opts;
-    unordered_map<char, OptName> m_shortNames;
-    unordered_map<string, OptName> m_longNames;
+    vector<OptName> m_shortNames;
+    // Position + 1 in m_shortNames of the entry for each character, or 0 if
+    // the character isn't a short name.
+    unsigned char m_shortSlots[256] = {};
+    vector<OptName> m_longNames;    // sorted by name
     vector<OptName> m_oprNames;
     bool m_allowCommands = {};
 
@@ -256,6 +367,18 @@ struct Cli::OptIndex {
     );
     void index(OptBase & opt);
 
+    // Parses name specification into the names, with their modifier flags,
+    // that are later indexed.
+    static void tokenize(
+        vector<OptBase::NameToken> * out,
+        const string & names
+    );
+
+    //-----------------------------------------------------------------------
+    // Queries
+    const OptName * findShortName(unsigned char name) const;
+    const OptName * findLongName(string_view name) const;
+
     //-----------------------------------------------------------------------
     // Help Text
     vector<OptKey> findNamedOpts(
@@ -267,16 +390,17 @@ struct Cli::OptIndex {
 
     // Members just to get access to protected members of OptBase.
     static string desc(const OptBase & opt, bool withMarkup = true);
-    static const unordered_map<string, OptBase::ChoiceDesc> & choiceDescs(
-        const OptBase & opt
-    );
+    static const OptBase::ChoiceTable & choices(const OptBase & opt);
 
     //-----------------------------------------------------------------------
     // Parsing
-    // Will completely rebuild index for new command if one is found.
-    bool parseToRawValues(
+    // Starts with the index in *ndx and, if a subcommand is found, replaces it
+    // with the index of that command.
+    static bool parseToRawValues(
         vector<RawValue> * out,
-        const vector<string> & args,
+        shared_ptr<const OptIndex> * ndx,
+        size_t argc,
+        const char * const argv[],
         Cli & cli
     );
 
@@ -301,16 +425,17 @@ private:
         int pos
     );
 
-    bool parseOperandValue(
+    static bool parseOperandValue(
         vector<RawValue> * out,
         ParseState & st,
         Cli & cli
     );
-    bool parseOptionValue(
+    static bool parseOptionValue(
         vector<RawValue> * out,
         ParseState & st,
         Cli & cli,
-        const vector<string> & args
+        size_t argc,
+        const char * const argv[]
     );
 
     string nameDescList(
@@ -354,7 +479,8 @@ static void helpOptAction(Cli & cli, Cli::Opt<bool> & opt, const string & val);
 static void defCmdAction(Cli & cli);
 static void writeChoicesDetail(
     string * outPtr,
-    const unordered_map<string, Cli::OptBase::ChoiceDesc> & choices
+    const Cli::OptBase::ChoiceTable & choices,
+    string_view val
 );
 static string format(const Cli::Config & cfg, const string & text);
 
@@ -487,10 +613,15 @@ CliLocal::CliLocal()
 //===========================================================================
 // static
 void Cli::Config::touchAllCmds(Cli & cli) {
-    // Make sure all opts have a backing command config.
-    for (auto && opt : cli.m_cfg->opts) {
-        if (!opt->allCmds())
-            Config::findCmdAlways(cli, opt->m_command);
+    // Make sure all opts have a backing command config, unless they haven't
+    // changed since the last time.
+    auto & cfg = *cli.m_cfg;
+    if (cfg.touchedGen != cfg.schemaGen) {
+        for (auto && opt : cfg.opts) {
+            if (!opt->allCmds())
+                Config::findCmdAlways(cli, opt->m_command);
+        }
+        cfg.touchedGen = cfg.schemaGen;
     }
     // Make sure all commands have a backing command group.
     for (auto && cmd : cli.m_cfg->cmds)
@@ -524,6 +655,7 @@ CommandConfig & Cli::Config::findCmdAlways(
         return i->second;
 
     auto & cmd = cmds[name];
+    cli.m_cfg->schemaGen += 1;
     cmd.name = name;
     cmd.action = defCmdAction;
     cmd.cmdGroup = cli.cmdGroup();
@@ -611,6 +743,109 @@ const GroupConfig & Cli::Config::findGrpOrDie(const Cli & cli) {
     return i->second;
 }
 
+//===========================================================================
+// static
+shared_ptr<const Cli::OptIndex> Cli::Config::findIndex(
+    const Cli & cli,
+    const string & cmd,
+    bool forHelpText
+) {
+    auto & cfg = *cli.m_cfg;
+    cfg.checkIndexes();
+    auto & ndx = forHelpText ? cfg.helpNdxs[cmd] : cfg.parseNdxs[cmd];
+    if (!ndx) {
+        auto tmp = make_shared<OptIndex>();
+        tmp->index(cli, cmd, forHelpText);
+        ndx = move(tmp);
+    }
+    return ndx;
+}
+
+//===========================================================================
+// static
+shared_ptr<const vector<Cli::OptBase *>> Cli::Config::findAfterOpts(
+    const Cli & cli,
+    const string & cmd
+) {
+    auto & cfg = *cli.m_cfg;
+    cfg.checkIndexes();
+    auto & afters = cfg.afterOpts[cmd];
+    if (!afters) {
+        auto tmp = make_shared<vector<OptBase *>>();
+        for (auto && opt : cfg.opts) {
+            if (opt->m_hasAfters && OptIndex::includeOptAfter(*opt, cmd))
+                tmp->push_back(opt.get());
+        }
+        afters = move(tmp);
+    }
+    return afters;
+}
+
+//===========================================================================
+void Cli::Config::checkIndexes() {
+    if (ndxGen == schemaGen)
+        return;
+    parseNdxs.clear();
+    helpNdxs.clear();
+    afterOpts.clear();
+    cmdOpts.clear();
+    for (auto && opt : opts)
+        cmdOpts[opt->command()].push_back(opt.get());
+    ndxGen = schemaGen;
+}
+
+//===========================================================================
+const string * Cli::Config::intern(const string & name) {
+    return &*names.insert(name).first;
+}
+
+//===========================================================================
+void Cli::Config::addOpt(unique_ptr<OptBase> src) {
+    src->m_cfg = this;
+    src->m_lazy = lazyValues;
+    src->m_slot = opts.size();
+    opts.push_back(move(src));
+    schemaGen += 1;
+}
+
+//===========================================================================
+void Cli::Config::fail(int code, const string & msg, const string & detail) {
+    parseExit = false;
+    exitCode = code;
+    errMsg = format(*this, msg);
+    errDetail = format(*this, detail);
+}
+
+//===========================================================================
+void Cli::Config::badUsage(
+    const string & prefix,
+    const string & value,
+    const string & detail
+) {
+    string out;
+    if (command.size())
+        out = "Command '" + command + "': ";
+    out += prefix;
+    if (!value.empty()) {
+        out += ": ";
+        out += value;
+    }
+    fail(kExitUsage, out, detail);
+    parseExit = true;
+}
+
+//===========================================================================
+void Cli::Config::badDeferred(
+    const OptBase & opt,
+    const ArgMatch & match,
+    const string & value
+) {
+    string prefix = "Invalid '" + *match.name + "' value";
+    string desc;
+    writeChoicesDetail(&desc, opt.choiceTable(), value);
+    badUsage(prefix, value, desc);
+}
+
 //===========================================================================
 Cli::Config::Config() {
     static size_t width = clamp<size_t>(
@@ -645,6 +880,404 @@ void Cli::Config::updateWidth(size_t width) {
 }
 
 
+/****************************************************************************
+*
+*   Cli::Convert
+*
+***/
+
+//===========================================================================
+static bool charconvLocale(const locale & loc) {
+    auto & np = use_facet<numpunct<char>>(loc);
+    return np.decimal_point() == '.' && np.thousands_sep() != '.';
+}
+
+//===========================================================================
+static bool tocharsLocale(const locale & loc) {
+    auto & np = use_facet<numpunct<char>>(loc);
+    return np.decimal_point() == '.' && np.grouping().empty();
+}
+
+//===========================================================================
+Cli::Convert::Convert()
+    : m_charconv(charconvLocale(m_locale))
+    , m_tochars(tocharsLocale(m_locale))
+{}
+
+//===========================================================================
+Cli::Convert::Convert(const locale & loc)
+    : m_locale(loc)
+    , m_charconv(charconvLocale(loc))
+    , m_tochars(tocharsLocale(loc))
+{}
+
+//===========================================================================
+locale Cli::Convert::imbueInterpreter(const locale & loc) {
+    m_charconv = charconvLocale(loc);
+    m_tochars = tocharsLocale(loc);
+    if (m_interpreter)
+        m_interpreter->imbue(loc);
+    auto prev = m_locale;
+    m_locale = loc;
+    return prev;
+}
+
+//===========================================================================
+stringstream & Cli::Convert::interpreter() const {
+    if (!m_interpreter) {
+        m_interpreter = make_unique<stringstream>();
+        m_interpreter->imbue(m_locale);
+    }
+    return *m_interpreter;
+}
+
+
+/****************************************************************************
+*
+*   Cli::Convert (Durations)
+*
+***/
+
+namespace {
+
+struct DurationUnit {
+    string_view name;
+    uintmax_t num; // length in seconds is num/den
+    uintmax_t den;
+};
+
+} // namespace
+
+// Units accepted when parsing, "m" is minutes as it is with timeUnits().
+static const DurationUnit s_durationUnits[] = {
+    {"y", 365 * 24 * 60 * 60, 1},
+    {"w", 7 * 24 * 60 * 60, 1},
+    {"d", 24 * 60 * 60, 1},
+    {"h", 60 * 60, 1},
+    {"min", 60, 1},
+    {"m", 60, 1},
+    {"s", 1, 1},
+    {"ms", 1, 1'000},
+    {"us", 1, 1'000'000},
+    {"ns", 1, 1'000'000'000},
+};
+
+// Units used when writing, largest first. Years are left out because they
+// aren't an exact number of days.
+static const DurationUnit s_durationOutUnits[] = {
+    {"w", 7 * 24 * 60 * 60, 1},
+    {"d", 24 * 60 * 60, 1},
+    {"h", 60 * 60, 1},
+    {"min", 60, 1},
+    {"s", 1, 1},
+    {"ms", 1, 1'000},
+    {"us", 1, 1'000'000},
+    {"ns", 1, 1'000'000'000},
+};
+
+//===========================================================================
+// Returns true if x * y overflows, otherwise sets *out to the product.
+static bool mulOverflow(uintmax_t * out, uintmax_t x, uintmax_t y) {
+    if (y && x > numeric_limits<uintmax_t>::max() / y)
+        return true;
+    *out = x * y;
+    return false;
+}
+
+//===========================================================================
+// Gets the ratio a/b of ticks, that are num/den seconds each, per unit.
+// Returns false if it can't be represented.
+static bool ticksPerUnit(
+    uintmax_t * a,
+    uintmax_t * b,
+    const DurationUnit & unit,
+    uintmax_t num,
+    uintmax_t den
+) {
+    auto g1 = gcd(unit.num, num);
+    auto g2 = gcd(unit.den, den);
+    return !mulOverflow(a, unit.num / g1, den / g2)
+        && !mulOverflow(b, unit.den / g2, num / g1);
+}
+
+//===========================================================================
+// Gets mant/10^exp units as ticks, rounded to nearest. Returns false if it
+// overflows.
+static bool unitsToTicks(
+    uintmax_t * out,
+    uintmax_t mant,
+    unsigned exp,
+    uintmax_t a,
+    uintmax_t b
+) {
+    // Fractional digits that make the divisor overflow are finer than any
+    // tick and are dropped.
+    auto div = b;
+    for (;;) {
+        auto tmp = div;
+        unsigned i = 0;
+        for (; i < exp; ++i) {
+            if (mulOverflow(&tmp, tmp, 10))
+                break;
+        }
+        if (i == exp) {
+            div = tmp;
+            break;
+        }
+        mant /= 10;
+        exp -= 1;
+    }
+    auto g = gcd(mant, div);
+    if (g > 1) {
+        mant /= g;
+        div /= g;
+    }
+    g = gcd(a, div);
+    if (g > 1) {
+        a /= g;
+        div /= g;
+    }
+    uintmax_t prod;
+    if (mulOverflow(&prod, mant, a))
+        return false;
+    *out = prod / div;
+    auto rem = prod % div;
+    if (rem && rem >= div - rem) {
+        if (*out == numeric_limits<uintmax_t>::max())
+            return false;
+        *out += 1;
+    }
+    return true;
+}
+
+//===========================================================================
+// static
+bool Cli::Convert::parseDuration(
+    DurationCount * out,
+    string_view src,
+    intmax_t num,
+    intmax_t den
+) {
+    *out = {};
+    auto ptr = src.data();
+    auto last = ptr + src.size();
+    if (ptr != last && (*ptr == '-' || *ptr == '+')) {
+        out->neg = *ptr == '-';
+        ptr += 1;
+    }
+    if (ptr == last)
+        return false;
+
+    // Ticks are the unit of bare numbers.
+    DurationUnit tick = { {}, (uintmax_t) num, (uintmax_t) den };
+    const auto kMaxMant = (numeric_limits<uintmax_t>::max() - 9) / 10;
+    unsigned parts = 0;
+    while (ptr != last) {
+        // Number, with optional fraction. Digits past what fits are only
+        // used by the approximation.
+        uintmax_t mant = 0;
+        unsigned exp = 0;
+        long double approx = 0;
+        bool digits = false;
+        bool overflow = false;
+        for (; ptr != last && *ptr >= '0' && *ptr <= '9'; ++ptr) {
+            digits = true;
+            approx = 10 * approx + (*ptr - '0');
+            if (mant > kMaxMant) {
+                overflow = true;
+            } else {
+                mant = 10 * mant + (*ptr - '0');
+            }
+        }
+        if (ptr != last && *ptr == '.') {
+            long double scale = 1;
+            for (++ptr; ptr != last && *ptr >= '0' && *ptr <= '9'; ++ptr) {
+                digits = true;
+                scale /= 10;
+                approx += scale * (*ptr - '0');
+                if (!overflow && mant <= kMaxMant) {
+                    mant = 10 * mant + (*ptr - '0');
+                    exp += 1;
+                }
+            }
+        }
+        if (!digits)
+            return false;
+
+        auto first = ptr;
+        while (ptr != last
+            && ((*ptr >= 'a' && *ptr <= 'z') || (*ptr >= 'A' && *ptr <= 'Z'))
+        ) {
+            ptr += 1;
+        }
+        string_view name(first, ptr - first);
+        const DurationUnit * unit = nullptr;
+        if (name.empty()) {
+            // Only a lone number may leave off the units.
+            if (parts || ptr != last)
+                return false;
+            unit = &tick;
+        } else {
+            for (auto && du : s_durationUnits) {
+                if (du.name == name) {
+                    unit = &du;
+                    break;
+                }
+            }
+            if (!unit)
+                return false;
+        }
+        parts += 1;
+
+        out->approx += approx * unit->num / unit->den * den / num;
+        if (out->overflow || !mant)
+            continue;
+        uintmax_t a;
+        uintmax_t b;
+        uintmax_t ticks;
+        if (overflow
+            || !ticksPerUnit(&a, &b, *unit, num, den)
+            || !unitsToTicks(&ticks, mant, exp, a, b)
+            || ticks > numeric_limits<uintmax_t>::max() - out->count
+        ) {
+            out->overflow = true;
+        } else {
+            out->count += ticks;
+        }
+    }
+    return true;
+}
+
+//===========================================================================
+// static
+void Cli::Convert::formatDuration(
+    string & out,
+    bool neg,
+    uintmax_t count,
+    intmax_t num,
+    intmax_t den
+) {
+    out.clear();
+    if (!count) {
+        out = "0";
+        out += durationUnit(num, den);
+        return;
+    }
+    if (neg)
+        out += '-';
+    for (auto && du : s_durationOutUnits) {
+        uintmax_t a;
+        uintmax_t b;
+        uintmax_t n;
+        if (ticksPerUnit(&a, &b, du, num, den)
+            && count % a == 0
+            && !mulOverflow(&n, count / a, b)
+        ) {
+            out += to_string(n);
+            out += du.name;
+            return;
+        }
+    }
+    // No unit fits exactly, fall back to the number of ticks.
+    out += to_string(count);
+}
+
+//===========================================================================
+// static
+string_view Cli::Convert::durationUnit(intmax_t num, intmax_t den) {
+    for (auto && du : s_durationOutUnits) {
+        if (du.num == (uintmax_t) num && du.den == (uintmax_t) den)
+            return du.name;
+    }
+    return {};
+}
+
+
+/****************************************************************************
+*
+*   Cli::UnitTable
+*
+*   Reverse trie of unit names, walked from the last character of the value
+*   so the suffix is matched without copying it out of the argument.
+*
+***/
+
+struct Cli::UnitTable {
+    struct Node {
+        // Children, keyed by the preceding character of the unit name.
+        vector<pair<char, unsigned>> next;
+        bool terminal = false;
+        long double factor = 0;
+    };
+    vector<Node> nodes{1}; // nodes[0] is the root
+    bool insensitive = false;
+
+    void add(const string & name, long double factor, bool replace);
+    bool find(
+        long double * factor,
+        string_view unit,
+        const ctype<char> & f
+    ) const;
+};
+
+//===========================================================================
+void Cli::UnitTable::add(
+    const string & name,
+    long double factor,
+    bool replace
+) {
+    unsigned pos = 0;
+    for (auto i = name.size(); i-- > 0;) {
+        auto ch = name[i];
+        auto & next = nodes[pos].next;
+        auto it = find_if(
+            next.begin(),
+            next.end(),
+            [ch](auto & kv) { return kv.first == ch; }
+        );
+        if (it != next.end()) {
+            pos = it->second;
+        } else {
+            auto child = (unsigned) nodes.size();
+            next.push_back({ch, child});
+            nodes.emplace_back();
+            pos = child;
+        }
+    }
+    auto & node = nodes[pos];
+    if (!node.terminal || replace) {
+        node.terminal = true;
+        node.factor = factor;
+    }
+}
+
+//===========================================================================
+bool Cli::UnitTable::find(
+    long double * factor,
+    string_view unit,
+    const ctype<char> & f
+) const {
+    unsigned pos = 0;
+    for (auto i = unit.size(); i-- > 0;) {
+        auto ch = insensitive ? f.tolower(unit[i]) : unit[i];
+        auto & next = nodes[pos].next;
+        auto it = find_if(
+            next.begin(),
+            next.end(),
+            [ch](auto & kv) { return kv.first == ch; }
+        );
+        if (it == next.end())
+            return false;
+        pos = it->second;
+    }
+    auto & node = nodes[pos];
+    if (!node.terminal)
+        return false;
+    *factor = node.factor;
+    return true;
+}
+
+
 /****************************************************************************
 *
 *   Cli::OptBase
@@ -654,16 +1287,19 @@ void Cli::Config::updateWidth(size_t width) {
 //===========================================================================
 Cli::OptBase::OptBase(const string & names, bool flag)
     : m_bool(flag)
-    , m_names(names)
 {
-    // Set m_fromName and assert if names is malformed.
+    // Parse the names once, then set m_fromName and assert if they're
+    // malformed.
+    OptIndex::tokenize(&m_nameTokens, names);
     OptIndex ndx;
     ndx.index(*this);
 }
 
 //===========================================================================
 locale Cli::OptBase::imbue(const locale & loc) {
-    return m_interpreter.imbue(loc);
+    // Choices are folded with the locale when ignoring case.
+    m_choiceTable.reset();
+    return imbueInterpreter(loc);
 }
 
 //===========================================================================
@@ -687,19 +1323,64 @@ void Cli::OptBase::setNameIfEmpty(const string & name) {
 }
 
 //===========================================================================
-bool Cli::OptBase::withUnits(
-    long double & out,
+void Cli::OptBase::indexChanged() {
+    if (m_cfg)
+        m_cfg->schemaGen += 1;
+}
+
+//===========================================================================
+bool Cli::OptBase::pendingAllowed() const {
+    return m_cfg && m_cfg->allowPending;
+}
+
+//===========================================================================
+unsigned Cli::OptBase::maxThreads() const {
+    return m_cfg ? m_cfg->maxThreads : 0;
+}
+
+//===========================================================================
+void Cli::OptBase::addListFileOpt(const string & names) {
+    assert(m_cfg && "List file for option not added to a cli.");
+    auto ptr = make_unique<Opt<string>>(
+        make_shared<Value<string>>(nullptr),
+        names
+    );
+    auto & opt = *ptr;
+    opt.valueDesc("FILE")
+        .desc("File listing more values, one per line ('-' for stdin).")
+        .command(m_command)
+        .group(m_group)
+        .parseView([target = this](auto & cli, auto & opt, string_view val) {
+            *opt = val;
+            cli.parseListFile(*target, opt, val);
+        });
+    m_listFileOpt = &opt;
+    m_cfg->addOpt(move(ptr));
+}
+
+//===========================================================================
+bool Cli::OptBase::convertOnAccess() const {
+    ArgMatch match;
+    string value;
+    if (convertDeferred(&match, &value))
+        return true;
+    m_cfg->badDeferred(*this, match, value);
+    return false;
+}
+
+//===========================================================================
+bool Cli::OptBase::splitUnits(
+    string_view * number,
+    string_view * unit,
     Cli & cli,
-    const string & val,
-    const unordered_map<string, long double> & units,
-    int flags
+    string_view val
 ) const {
-    auto & f = use_facet<ctype<char>>(m_interpreter.getloc());
+    auto & f = use_facet<ctype<char>>(m_locale);
 
     auto pos = val.size();
     for (;;) {
         if (!pos--) {
-            cli.badUsage(*this, val);
+            cli.badUsage(*this, string(val));
             return false;
         }
         if (f.is(f.digit, val[pos]) || val[pos] == '.') {
@@ -707,38 +1388,211 @@ bool Cli::OptBase::withUnits(
             break;
         }
     }
-    auto num = val.substr(0, pos);
-    auto unit = val.substr(pos);
+    *number = val.substr(0, pos);
+    *unit = val.substr(pos);
+    return true;
+}
 
-    if (!fromString(out, num)) {
-        cli.badUsage(*this, val);
-        return false;
-    }
+//===========================================================================
+bool Cli::OptBase::unitsFactor(
+    long double * factor,
+    Cli & cli,
+    string_view val,
+    string_view unit,
+    const UnitTable & units,
+    int flags
+) const {
     if (unit.empty()) {
+        *factor = 1;
         if (~flags & fUnitRequire)
             return true;
         cli.badUsage(
             *this,
-            val,
+            string(val),
             "Value requires suffix specifying the units."
         );
         return false;
     }
 
-    if (flags & fUnitInsensitive)
-        f.tolower(unit.data(), unit.data() + unit.size());
-    auto i = units.find(unit);
-    if (i != units.end()) {
-        out *= i->second;
+    auto & f = use_facet<ctype<char>>(m_locale);
+    if (units.find(factor, unit, f))
         return true;
-    } else {
-        cli.badUsage(
-            *this,
-            val,
-            "Units symbol '" + unit + "' not recognized."
-        );
-        return false;
+
+    string name(unit);
+    if (flags & fUnitInsensitive)
+        f.tolower(name.data(), name.data() + name.size());
+    cli.badUsage(
+        *this,
+        string(val),
+        "Units symbol '" + name + "' not recognized."
+    );
+    return false;
+}
+
+
+/****************************************************************************
+*
+*   Cli::OptBase::ChoiceTable
+*
+***/
+
+struct Cli::OptBase::ChoiceTable {
+    using Entry = pair<const string, ChoiceDesc>;
+    using Key = pair<string_view, const Entry *>;
+
+    // Sorted by key, which is folded to lowercase when ignoring case.
+    vector<Key> keys;
+    // Sorted by the key as given, only used when ignoring case.
+    vector<Key> exact;
+    // Folded keys referenced by 'keys', reserved up front so the views of
+    // them stay valid.
+    vector<string> folded;
+    // In help text order, sorted by sort key and then the order added.
+    vector<const Entry *> help;
+
+    bool insensitive = false;
+    bool prefix = false;
+    locale loc;
+
+    string fold(string_view key) const;
+    pair<vector<Key>::const_iterator, vector<Key>::const_iterator>
+        prefixRange(string_view key) const;
+    const Entry * find(string_view val) const;
+    vector<const Entry *> prefixMatches(string_view val) const;
+};
+
+//===========================================================================
+string Cli::OptBase::ChoiceTable::fold(string_view key) const {
+    string out(key);
+    auto & f = use_facet<ctype<char>>(loc);
+    f.tolower(out.data(), out.data() + out.size());
+    return out;
+}
+
+//===========================================================================
+// Returns the range of keys that start with the key.
+auto Cli::OptBase::ChoiceTable::prefixRange(string_view key) const
+    -> pair<vector<Key>::const_iterator, vector<Key>::const_iterator>
+{
+    auto first = lower_bound(
+        keys.begin(),
+        keys.end(),
+        key,
+        [](auto & a, string_view b) { return a.first < b; }
+    );
+    auto last = upper_bound(
+        first,
+        keys.end(),
+        key,
+        [](string_view a, auto & b) { return a < b.first.substr(0, a.size()); }
+    );
+    return {first, last};
+}
+
+//===========================================================================
+auto Cli::OptBase::ChoiceTable::find(string_view val) const -> const Entry * {
+    auto & list = insensitive ? exact : keys;
+    auto i = lower_bound(
+        list.begin(),
+        list.end(),
+        val,
+        [](auto & a, string_view b) { return a.first < b; }
+    );
+    if (i != list.end() && i->first == val)
+        return i->second;
+    if (!insensitive && !prefix)
+        return nullptr;
+
+    string tmp;
+    if (insensitive) {
+        tmp = fold(val);
+        val = tmp;
+    }
+    auto [first, last] = prefixRange(val);
+    if (first == last)
+        return nullptr;
+    if (first->first == val) {
+        // Matches regardless of case, but only if there's just one choice
+        // that does.
+        if (next(first) == last || next(first)->first != val)
+            return first->second;
+        return nullptr;
+    }
+    if (prefix && !val.empty() && next(first) == last)
+        return first->second;
+    return nullptr;
+}
+
+//===========================================================================
+// Returns the choices the value is a prefix of when there's more than one,
+// so that matching them would be ambiguous.
+auto Cli::OptBase::ChoiceTable::prefixMatches(string_view val) const
+    -> vector<const Entry *>
+{
+    vector<const Entry *> out;
+    if (!prefix || val.empty())
+        return out;
+    string tmp;
+    if (insensitive) {
+        tmp = fold(val);
+        val = tmp;
     }
+    auto [first, last] = prefixRange(val);
+    if (last - first < 2)
+        return out;
+    for (; first != last; ++first)
+        out.push_back(first->second);
+    return out;
+}
+
+//===========================================================================
+const Cli::OptBase::ChoiceDesc * Cli::OptBase::findChoice(
+    string_view value
+) const {
+    auto cd = choiceTable().find(value);
+    return cd ? &cd->second : nullptr;
+}
+
+//===========================================================================
+const Cli::OptBase::ChoiceTable & Cli::OptBase::choiceTable() const {
+    if (m_choiceTable)
+        return *m_choiceTable;
+    if (m_choiceDescs.empty()) {
+        static const ChoiceTable s_empty;
+        return s_empty;
+    }
+
+    auto tbl = make_shared<ChoiceTable>();
+    tbl->insensitive = m_choiceFlags & fChoiceInsensitive;
+    tbl->prefix = m_choiceFlags & fChoicePrefix;
+    tbl->loc = m_locale;
+    auto num = m_choiceDescs.size();
+    tbl->keys.reserve(num);
+    tbl->help.reserve(num);
+    if (tbl->insensitive) {
+        tbl->exact.reserve(num);
+        tbl->folded.reserve(num);
+    }
+    for (auto && cd : m_choiceDescs) {
+        tbl->help.push_back(&cd);
+        if (tbl->insensitive) {
+            tbl->exact.push_back({cd.first, &cd});
+            tbl->folded.push_back(tbl->fold(cd.first));
+            tbl->keys.push_back({tbl->folded.back(), &cd});
+        } else {
+            tbl->keys.push_back({cd.first, &cd});
+        }
+    }
+    auto byKey = [](auto & a, auto & b) { return a.first < b.first; };
+    sort(tbl->keys.begin(), tbl->keys.end(), byKey);
+    sort(tbl->exact.begin(), tbl->exact.end(), byKey);
+    sort(tbl->help.begin(), tbl->help.end(), [](auto & a, auto & b) {
+        if (int rc = a->second.sortKey.compare(b->second.sortKey))
+            return rc < 0;
+        return a->second.pos < b->second.pos;
+    });
+    m_choiceTable = tbl;
+    return *tbl;
 }
 
 
@@ -798,35 +1652,82 @@ void Cli::OptIndex::index(
     *this = {};
     m_allowCommands = cmd.empty();
 
+    // Only options belonging to the command, directly or as one of all
+    // commands, need to be considered.
+    auto & cmdOpts = cli.m_cfg->cmdOpts;
     if (cli.commandExists(cmd)) {
         // Options configured for all commands are only processed by existing
         // (as opposed to "unknown") commands. These are added first so that
         // any following command specific options will override them.
-        for (auto && opt : cli.m_cfg->opts) {
+        vector<OptBase *> opts;
+        for (auto name : {&kInternalAllCmds, &kInternalAllSubcmds}) {
+            auto i = cmdOpts.find(*name);
+            if (i != cmdOpts.end())
+                opts.insert(opts.end(), i->second.begin(), i->second.end());
+        }
+        // Keep them in the order they were added to the cli.
+        sort(opts.begin(), opts.end(), [](auto & a, auto & b) {
+            return a->m_slot < b->m_slot;
+        });
+        for (auto && opt : opts) {
             if (includeOpt(*opt, cmd, forHelpText, true))
                 index(*opt);
         }
     }
     // Every command processes the options explicitly configured for it.
-    for (auto && opt : cli.m_cfg->opts) {
-        if (includeOpt(*opt, cmd, forHelpText, false))
-            index(*opt);
+    auto i = cmdOpts.find(cmd);
+    if (i != cmdOpts.end()) {
+        for (auto && opt : i->second) {
+            if (includeOpt(*opt, cmd, forHelpText, false))
+                index(*opt);
+        }
     }
 
     if (m_final < Final::kOpt)
         m_finalOpr = -1;
 
+    // Sort long names for lookup, when a name was indexed more than once the
+    // last one wins.
+    stable_sort(
+        m_longNames.begin(),
+        m_longNames.end(),
+        [](auto & a, auto & b) { return a.name < b.name; }
+    );
+    auto out = m_longNames.begin();
+    for (auto i = m_longNames.begin(); i != m_longNames.end(); ++i) {
+        if (i + 1 != m_longNames.end() && i[1].name == i->name)
+            continue;
+        if (out != i)
+            *out = move(*i);
+        ++out;
+    }
+    m_longNames.erase(out, m_longNames.end());
+
     for (unsigned i = 0; i < m_oprNames.size(); ++i) {
         auto & key = m_oprNames[i];
         if (key.name.empty())
             key.name = "ARG" + to_string(i + 1);
+        key.from = cli.m_cfg->intern(key.name);
+        key.slot = key.opt->m_slot;
+    }
+    for (auto && sn : m_shortNames) {
+        sn.from = cli.m_cfg->intern("-" + sn.name);
+        sn.slot = sn.opt->m_slot;
+    }
+    for (auto && ln : m_longNames) {
+        ln.from = cli.m_cfg->intern("--" + ln.name);
+        ln.slot = ln.opt->m_slot;
     }
 }
 
 //===========================================================================
-void Cli::OptIndex::index(OptBase & opt) {
-    auto base = opt.m_names.c_str();
-    auto last = base + opt.m_names.size();
+// static
+void Cli::OptIndex::tokenize(
+    vector<OptBase::NameToken> * out,
+    const string & names
+) {
+    auto base = names.c_str();
+    auto last = base + names.size();
     auto cur = base;
 
     auto nameptr = cur;
@@ -837,8 +1738,6 @@ void Cli::OptIndex::index(OptBase & opt) {
     const char * suffix;
     size_t nameLen;
     unsigned char ch;
-    bool added;
-    bool hasOpr = false;
 
 IN_GAP:
     while (cur < last) {
@@ -850,7 +1749,7 @@ IN_GAP:
 
 IN_PREFIX:
     nameptr = cur - 1;
-    flags = opt.m_finalOpt ? fNameFinal : 0;
+    flags = 0;
     name.clear();
     close = 0;
 
@@ -896,7 +1795,7 @@ IN_PREFIX:
 
 ADD_SHORT_NAME:
     name = *nameptr;
-    flags = 0;
+    flags = fNameLiteral;
     goto ADD_NAME;
 
 IN_UNQUOTED_NAME:
@@ -966,53 +1865,79 @@ IN_SUFFIX:
     goto ADD_NAME;
 
 ADD_NAME:
-    added = false;
-    if (flags & fNameError)
-        goto IN_GAP;
-    auto pos = int(cur - base);
-    if (flags & fNameOperand) {
-        if (hasOpr) {
-            assert(!"Opt with multiple operand names.");
-        } else {
-            added = indexOperandName(opt, trim(name), flags, pos);
-            hasOpr = added;
+    if (~flags & fNameError) {
+        if (flags & fNameOperand)
+            name = trim(name);
+        out->push_back({name, flags, int(cur - base)});
+    }
+    goto IN_GAP;
+}
+
+//===========================================================================
+void Cli::OptIndex::index(OptBase & opt) {
+    // Freeze the choices, so that matching values with them while parsing
+    // only reads the table.
+    if (!opt.m_choiceDescs.empty())
+        opt.choiceTable();
+
+    bool hasOpr = false;
+    for (auto && tok : opt.m_nameTokens) {
+        auto & name = tok.name;
+        auto flags = tok.flags;
+        auto pos = tok.pos;
+        if (flags & fNameLiteral) {
+            // Single character names made up of what would otherwise be a
+            // modifier don't pick up opt.finalOpt().
+            flags &= ~fNameLiteral;
+        } else if (opt.m_finalOpt) {
+            flags |= fNameFinal;
         }
-    } else {
-        if (opt.m_bool) {
-            if (flags & fNameOptional) {
-                // Bool options don't have values, only their presences or
-                // absence, therefore they can't have optional values.
-                assert(!"Bad prefix modifier '?' for bool option.");
-                goto IN_GAP;
-            }
-            if (flags & fNameList) {
-                // Bool options also can't have multiple values.
-                assert(!"Bad prefix modifier '*' for bool option.");
-                goto IN_GAP;
+
+        bool added = false;
+        if (flags & fNameOperand) {
+            if (hasOpr) {
+                assert(!"Opt with multiple operand names.");
+            } else {
+                added = indexOperandName(opt, name, flags, pos);
+                hasOpr = added;
             }
         } else {
-            if (flags & fNameInvert) {
-                // Inversion doesn't make any sense for non-bool options and
-                // will be ignored for them. But it is allowed to be specified
-                // because they might be turned into flagValues, and flagValues
-                // act like bools syntactically.
-                //
-                // And the case of an inverted bool converted to a flagValue
-                // has to be handled anyway.
+            if (opt.m_bool) {
+                if (flags & fNameOptional) {
+                    // Bool options don't have values, only their presences or
+                    // absence, therefore they can't have optional values.
+                    assert(!"Bad prefix modifier '?' for bool option.");
+                    continue;
+                }
+                if (flags & fNameList) {
+                    // Bool options also can't have multiple values.
+                    assert(!"Bad prefix modifier '*' for bool option.");
+                    continue;
+                }
+            } else {
+                if (flags & fNameInvert) {
+                    // Inversion doesn't make any sense for non-bool options
+                    // and will be ignored for them. But it is allowed to be
+                    // specified because they might be turned into
+                    // flagValues, and flagValues act like bools
+                    // syntactically.
+                    //
+                    // And the case of an inverted bool converted to a
+                    // flagValue has to be handled anyway.
+                }
+            }
+            if (name.size() == 1) {
+                added = indexShortName(opt, name[0], flags, pos);
+            } else {
+                assert(name.size() >= 2);
+                added = indexLongName(opt, name, flags, pos);
             }
         }
-        if (name.size() == 1) {
-            added = indexShortName(opt, name[0], flags, pos);
-        } else {
-            assert(name.size() >= 2);
-            added = indexLongName(opt, name, flags, pos);
+        if (added) {
+            if (m_opts.empty() || m_opts.back() != &opt)
+                m_opts.push_back(&opt);
         }
     }
-    if (added) {
-        if (m_opts.empty() || m_opts.back() != &opt)
-            m_opts.push_back(&opt);
-    }
-    goto IN_GAP;
 }
 
 //===========================================================================
@@ -1091,7 +2016,13 @@ bool Cli::OptIndex::indexShortName(
         assert(!"Bad suffix modifier '.' for short name.");
         return false;
     }
-    m_shortNames[name] = {&opt, flags, {}, pos};
+    auto & slot = m_shortSlots[(unsigned char) name];
+    if (slot) {
+        m_shortNames[slot - 1] = {&opt, flags, string(1, name), pos};
+    } else {
+        m_shortNames.push_back({&opt, flags, string(1, name), pos});
+        slot = (unsigned char) m_shortNames.size();
+    }
     opt.setNameIfEmpty("-"s + name);
     return true;
 }
@@ -1103,16 +2034,43 @@ bool Cli::OptIndex::indexLongName(
     unsigned flags,
     int pos
 ) {
-    m_longNames[name] = {&opt, flags, {}, pos};
+    m_longNames.push_back({&opt, flags, name, pos});
     if ((~flags & fNameExcludeNo) && opt.m_bool && !opt.m_flagValue) {
         flags ^= fNameInvert;
-        m_longNames["no-" + name] = {&opt, flags, {}, pos + 1};
+        m_longNames.push_back({&opt, flags, "no-" + name, pos + 1});
     }
     opt.setNameIfEmpty("--" + name);
     return true;
 }
 
 
+/****************************************************************************
+*
+*   Queries
+*
+***/
+
+//===========================================================================
+const OptName * Cli::OptIndex::findShortName(unsigned char name) const {
+    if (auto slot = m_shortSlots[name])
+        return &m_shortNames[slot - 1];
+    return nullptr;
+}
+
+//===========================================================================
+const OptName * Cli::OptIndex::findLongName(string_view name) const {
+    auto i = lower_bound(
+        m_longNames.begin(),
+        m_longNames.end(),
+        name,
+        [](auto & a, auto & b) { return string_view(a.name) < b; }
+    );
+    if (i == m_longNames.end() || i->name != name)
+        return nullptr;
+    return &*i;
+}
+
+
 /****************************************************************************
 *
 *   Action callbacks
@@ -1121,13 +2079,13 @@ bool Cli::OptIndex::indexLongName(
 
 //===========================================================================
 // static
-void Cli::defParseAction(Cli & cli, OptBase & opt, const string & val) {
+void Cli::defParseAction(Cli & cli, OptBase & opt, string_view val) {
     if (opt.parseValue(val))
         return;
 
     string desc;
-    writeChoicesDetail(&desc, opt.m_choiceDescs);
-    cli.badUsage(opt, val, desc);
+    writeChoicesDetail(&desc, opt.choiceTable(), val);
+    cli.badUsage(opt, string(val), desc);
 }
 
 //===========================================================================
@@ -1174,10 +2132,11 @@ static void defCmdAction(Cli & cli) {
 
 //===========================================================================
 static void helpCmdAction(Cli & cli) {
-    Cli::OptIndex ndx;
-    ndx.index(cli, cli.commandMatched(), false);
-    auto & cmd = *static_cast<Cli::Opt<string> &>(*ndx.m_oprNames[0].opt);
-    auto & usage = *static_cast<Cli::Opt<bool> &>(*ndx.m_shortNames['u'].opt);
+    auto ndx = Cli::Config::findIndex(cli, cli.commandMatched(), false);
+    auto & cmd = *static_cast<Cli::Opt<string> &>(*ndx->m_oprNames[0].opt);
+    auto & usage = *static_cast<Cli::Opt<bool> &>(
+        *ndx->findShortName('u')->opt
+    );
     if (!cli.commandExists(cmd))
         return cli.badUsage("Help requested for unknown command", cmd);
 
@@ -1287,7 +2246,7 @@ std::string Cli::fixCmdName(const std::string & name) {
 //===========================================================================
 // private
 void Cli::addOpt(unique_ptr<OptBase> src) {
-    m_cfg->opts.push_back(move(src));
+    m_cfg->addOpt(move(src));
 }
 
 //===========================================================================
@@ -1634,6 +2593,28 @@ Cli && Cli::responseFiles(bool enable) && {
     return move(responseFiles(enable));
 }
 
+//===========================================================================
+Cli & Cli::lazyValues(bool enable) & {
+    m_cfg->lazyValues = enable;
+    return *this;
+}
+
+//===========================================================================
+Cli && Cli::lazyValues(bool enable) && {
+    return move(lazyValues(enable));
+}
+
+//===========================================================================
+Cli & Cli::maxThreads(unsigned threads) & {
+    m_cfg->maxThreads = threads;
+    return *this;
+}
+
+//===========================================================================
+Cli && Cli::maxThreads(unsigned threads) && {
+    return move(maxThreads(threads));
+}
+
 //===========================================================================
 Cli & Cli::iostreams(istream * in, ostream * out) & {
     m_cfg->conin = in ? in : &cin;
@@ -1674,8 +2655,103 @@ Cli & Cli::afterExec(function<ActionFn> fn) & {
 }
 
 //===========================================================================
-Cli && Cli::afterExec(function<ActionFn> fn) && {
-    return move(afterExec(fn));
+Cli && Cli::afterExec(function<ActionFn> fn) && {
+    return move(afterExec(fn));
+}
+
+
+/****************************************************************************
+*
+*   Unit tables (Configuration)
+*
+***/
+
+//===========================================================================
+namespace {
+
+struct UnitTableRegistry {
+    mutex mut;
+    unordered_map<string, weak_ptr<const Cli::UnitTable>> tables;
+};
+
+} // namespace
+
+//===========================================================================
+// Function local so that options defined by static initializers in other
+// translation units can safely use it.
+static UnitTableRegistry & unitTableRegistry() {
+    static UnitTableRegistry s_reg;
+    return s_reg;
+}
+
+//===========================================================================
+static shared_ptr<const Cli::UnitTable> findUnitTable(const string & key) {
+    auto & reg = unitTableRegistry();
+    scoped_lock lk{reg.mut};
+    auto i = reg.tables.find(key);
+    return i == reg.tables.end() ? nullptr : i->second.lock();
+}
+
+//===========================================================================
+// Builds the table and registers it under the key, unless an equivalent
+// table was registered in the meantime. Tables are only referenced weakly
+// by the registry, so they go away with the last option using them.
+static shared_ptr<const Cli::UnitTable> addUnitTable(
+    const string & key,
+    const vector<pair<string, long double>> & units,
+    int flags
+) {
+    auto table = make_shared<Cli::UnitTable>();
+    table->insensitive = flags & Cli::fUnitInsensitive;
+    auto & f = use_facet<ctype<char>>(locale());
+    string name;
+    for (auto && kv : units) {
+        name = kv.first;
+        if (table->insensitive) {
+            // The last of the names that differ only by case wins.
+            f.tolower(name.data(), name.data() + name.size());
+            table->add(name, kv.second, true);
+        } else {
+            table->add(name, kv.second, false);
+        }
+    }
+
+    auto & reg = unitTableRegistry();
+    scoped_lock lk{reg.mut};
+    auto & ref = reg.tables[key];
+    if (auto found = ref.lock())
+        return found;
+    for (auto i = reg.tables.begin(); i != reg.tables.end();) {
+        if (i->second.expired() && &i->second != &ref) {
+            i = reg.tables.erase(i);
+        } else {
+            ++i;
+        }
+    }
+    ref = table;
+    return table;
+}
+
+//===========================================================================
+// static
+shared_ptr<const Cli::UnitTable> Cli::unitTable(
+    const vector<pair<string, long double>> & units,
+    int flags
+) {
+    flags &= fUnitInsensitive;
+    auto key = "any:" + to_string(flags);
+    char buf[64];
+    for (auto && kv : units) {
+        key += ':';
+        key += to_string(kv.first.size());
+        key += '=';
+        key += kv.first;
+        snprintf(buf, sizeof buf, "%La", kv.second);
+        key += buf;
+    }
+    if (auto table = findUnitTable(key))
+        return table;
+    return addUnitTable(key, units, flags);
 }
 
 
@@ -1715,22 +2791,24 @@ static vector<pair<string, double>> s_siSmall({
 });
 
 //===========================================================================
-// static
-vector<pair<string, double>> Cli::siUnitMapping(
+static vector<pair<string, long double>> siUnitMapping(
     const string & symbol,
     int flags
 ) {
-    vector<pair<string, double>> units = s_siBinExplicit;
-    if (flags & fUnitBinaryPrefix) {
+    vector<pair<string, long double>> units(
+        s_siBinExplicit.begin(),
+        s_siBinExplicit.end()
+    );
+    if (flags & Cli::fUnitBinaryPrefix) {
         units.insert(units.end(), s_siBin.begin(), s_siBin.end());
     } else {
         units.insert(units.end(), s_siDec.begin(), s_siDec.end());
-        if (~flags & fUnitInsensitive) {
+        if (~flags & Cli::fUnitInsensitive) {
             units.insert(units.end(), s_siSmall.begin(), s_siSmall.end());
         }
     }
     if (!symbol.empty()) {
-        if (flags & fUnitRequire) {
+        if (flags & Cli::fUnitRequire) {
             for (auto && kv : units)
                 kv.first += symbol;
         } else {
@@ -1745,6 +2823,41 @@ vector<pair<string, double>> Cli::siUnitMapping(
     return units;
 }
 
+//===========================================================================
+// static
+shared_ptr<const Cli::UnitTable> Cli::siUnitTable(
+    const string & symbol,
+    int flags
+) {
+    flags &= fUnitBinaryPrefix | fUnitInsensitive | fUnitRequire;
+    auto key = "si:" + to_string(flags) + ':' + symbol;
+    if (auto table = findUnitTable(key))
+        return table;
+    return addUnitTable(key, siUnitMapping(symbol, flags), flags);
+}
+
+//===========================================================================
+// static
+shared_ptr<const Cli::UnitTable> Cli::timeUnitTable(int flags) {
+    flags &= fUnitInsensitive;
+    auto key = "time:" + to_string(flags);
+    if (auto table = findUnitTable(key))
+        return table;
+    vector<pair<string, long double>> units = {
+        {"y", 365 * 24 * 60 * 60},
+        {"w", 7 * 24 * 60 * 60},
+        {"d", 24 * 60 * 60},
+        {"h", 60 * 60},
+        {"m", 60},
+        {"min", 60},
+        {"s", 1},
+        {"ms", 1e-3L},
+        {"us", 1e-6L},
+        {"ns", 1e-9L},
+    };
+    return addUnitTable(key, units, flags);
+}
+
 
 /****************************************************************************
 *
@@ -1868,6 +2981,62 @@ static bool expandResponseFiles(
 #endif
 
 
+/****************************************************************************
+*
+*   List files
+*
+*   Unlike response files, entries are taken as is, without quoting rules, so
+*   very long lists are split with a single search for each separator.
+*
+***/
+
+//===========================================================================
+bool Cli::parseListFile(OptBase & out, const OptBase & src, string_view path) {
+    auto name = m_cfg->intern(src.from());
+    auto pos = (size_t) src.pos();
+    string fn(path);
+    MappedFile file;
+    string content;
+    string_view text;
+    if (fn == "-") {
+        content.assign(istreambuf_iterator<char>(conin()), {});
+        text = content;
+    } else if (file.open(fn)) {
+        text = file.view();
+    } else {
+        // Files that can't be mapped, such as pipes, are read instead.
+        ifstream f(fn, ios::binary);
+        if (!f) {
+            badUsage("Invalid list file", fn);
+            return false;
+        }
+        content.assign(istreambuf_iterator<char>(f), {});
+        if (f.bad()) {
+            badUsage("Read error", fn);
+            return false;
+        }
+        text = content;
+    }
+    if (text.substr(0, 3) == "\xef\xbb\xbf")
+        text.remove_prefix(3);
+
+    // Entries are NUL separated, as made by "find -print0", if there are any
+    // NULs, otherwise there's one per line.
+    auto sep = text.find('\0') == text.npos ? '\n' : '\0';
+    out.reserveValues(count(text.begin(), text.end(), sep) + 1);
+    for (size_t first = 0; first < text.size();) {
+        auto last = min(text.find(sep, first), text.size());
+        auto entry = text.substr(first, last - first);
+        first = last + 1;
+        if (sep == '\n' && !entry.empty() && entry.back() == '\r')
+            entry.remove_suffix(1);
+        if (!entry.empty() && !parseListEntry(out, name, pos, entry))
+            return false;
+    }
+    return true;
+}
+
+
 /****************************************************************************
 *
 *   Parse command line
@@ -1968,19 +3137,21 @@ static bool matchOperands(
         }
         auto & oprName = ndx.m_oprNames[ipos];
         val->opt = oprName.opt;
-        val->name = oprName.name;
+        val->name = oprName.from;
         imatch += 1;
     }
     return true;
 }
 
 //===========================================================================
+// static
 bool Cli::OptIndex::parseOperandValue(
     vector<RawValue> * out,
     ParseState & st,
     Cli & cli
 ) {
-    if (st.cmdMode == ParseState::kPending && st.numOprs == m_minOprs) {
+    auto & ndx = *st.ndx;
+    if (st.cmdMode == ParseState::kPending && st.numOprs == ndx.m_minOprs) {
         // We've been expecting a subcommand name and, after any other
         // operands, it's finally arrived.
         auto cmd = (string)st.ptr;
@@ -1990,7 +3161,7 @@ bool Cli::OptIndex::parseOperandValue(
             out->data(),
             out->size(),
             cli,
-            *this,
+            ndx,
             st.numOprs
         );
         // Number of assigned operands should always exactly match the
@@ -2001,7 +3172,8 @@ bool Cli::OptIndex::parseOperandValue(
 
         // Add command raw value and prepare for new set of opt rules
         // that are defined by the command.
-        out->push_back({ RawValue::kCommand, nullptr, cmd });
+        auto name = cli.m_cfg->intern(cmd);
+        out->push_back({ RawValue::kCommand, nullptr, name });
         st.precmdValues = out->size();
         st.numOprs = 0;
 
@@ -2009,7 +3181,7 @@ bool Cli::OptIndex::parseOperandValue(
         if (exists && !cli.m_cfg->cmds[cmd].unknownArgs) {
             // Command exists and it's args are to be processed normally
             st.cmdMode = ParseState::kFound;
-            index(cli, cmd, false);
+            st.ndx = Config::findIndex(cli, cmd, false);
         } else if (exists || cli.m_cfg->allowUnknown) {
             // Known command marked for unknown argument processing or allowed
             // unknown command.
@@ -2032,7 +3204,7 @@ bool Cli::OptIndex::parseOperandValue(
         return true;
     }
 
-    if (st.numOprs == m_finalOpr) {
+    if (st.numOprs == ndx.m_finalOpr) {
         // Operand marked as finalOpt, record so that all remaining arguments
         // are treaded as operands.
         st.moreOpts = false;
@@ -2042,7 +3214,7 @@ bool Cli::OptIndex::parseOperandValue(
     out->push_back({
         RawValue::kOperand,
         nullptr,
-        string{},
+        nullptr,
         st.argPos,
         st.ptr
     });
@@ -2057,29 +3229,31 @@ static void addOptionMatch(
     ParseState & st,
     const char * ptr
 ) {
-    st.optMatches[st.optName.opt] += 1;
+    st.optMatches[st.optName->slot] += 1;
     out->push_back({
         RawValue::kOption,
-        st.optName.opt,
-        st.name,
+        st.optName->opt,
+        st.optName->from,
         st.argPos,
         ptr
     });
 }
 
 //===========================================================================
+// static
 bool Cli::OptIndex::parseOptionValue(
     vector<RawValue> * out,
     ParseState & st,
     Cli & cli,
-    const vector<string> & args
+    size_t argc,
+    const char * const argv[]
 ) {
     if (st.ptr) {
         // Option with attached value (in the same argument).
         addOptionMatch(out, st, st.ptr);
         return true;
     }
-    if (st.optName.flags & fNameOptional) {
+    if (st.optName->flags & fNameOptional) {
         // Option allows optional value and has no value attached. Treat the
         // value as not present.
         addOptionMatch(out, st, nullptr);
@@ -2089,25 +3263,26 @@ bool Cli::OptIndex::parseOptionValue(
     // Option has required value but has no value attached. Use next argument
     // as the value.
     st.argPos += 1;
-    if (st.argPos == args.size()) {
-        cli.badUsage("No value given for " + st.name);
+    if (st.argPos == argc) {
+        cli.badUsage("No value given for " + *st.optName->from);
         return false;
     }
-    addOptionMatch(out, st, args[st.argPos].c_str());
+    addOptionMatch(out, st, argv[st.argPos]);
 
     // Option has value list, use following arguments up to the next option as
     // values.
-    if (st.optName.flags & fNameList) {
-        while (st.argPos + 1 < args.size()) {
-            auto val = args[st.argPos + 1].c_str();
+    if (st.optName->flags & fNameList) {
+        while (st.argPos + 1 < argc) {
+            auto val = argv[st.argPos + 1];
             if (*val == '-') {
                 // The next argument looks like an option, so stop taking
                 // arguments.
                 break;
             }
-            if (st.optName.opt->m_vector
-                && st.optName.opt->maxSize() != -1
-                && st.optMatches[st.optName.opt] >= st.optName.opt->maxSize()
+            auto & opt = *st.optName->opt;
+            if (opt.m_vector
+                && opt.maxSize() != -1
+                && st.optMatches[st.optName->slot] >= opt.maxSize()
             ) {
                 // Don't take more arguments as it would push the vector past
                 // it's maximum size.
@@ -2126,13 +3301,18 @@ static bool commandRequired(const Cli::Config & cfg) {
 }
 
 //===========================================================================
+// static
 bool Cli::OptIndex::parseToRawValues(
     vector<RawValue> * out,
-    const vector<string> & args,
+    shared_ptr<const OptIndex> * ndx,
+    size_t argc,
+    const char * const argv[],
     Cli & cli
 ) {
-    cli.m_cfg->progName = args[0];
+    cli.m_cfg->progName = argv[0];
     ParseState st;
+    st.ndx = *ndx;
+    st.optMatches.resize(cli.m_cfg->opts.size());
     if (cli.m_cfg->cmds[""].unknownArgs) {
         st.cmdMode = ParseState::kUnknown;
         st.moreOpts = false;
@@ -2140,26 +3320,24 @@ bool Cli::OptIndex::parseToRawValues(
         st.cmdMode = ParseState::kPending;
     }
 
-    for (; st.argPos < args.size(); ++st.argPos) {
-        st.ptr = args[st.argPos].c_str();
+    for (; st.argPos < argc; ++st.argPos) {
+        st.ptr = argv[st.argPos];
         if (*st.ptr == '-' && st.ptr[1] && st.moreOpts) {
             // Argument contains one or more options.
             st.ptr += 1;
             // Process all options with short names contained in the argument.
             for (; *st.ptr && *st.ptr != '-'; ++st.ptr) {
                 // Found short name in argument.
-                st.name = '-';
-                st.name += *st.ptr;
-                auto it = m_shortNames.find(*st.ptr);
-                if (it == m_shortNames.end()) {
-                    cli.badUsage("Unknown option", st.name);
+                auto found = st.ndx->findShortName(*st.ptr);
+                if (!found) {
+                    cli.badUsage("Unknown option", "-"s + *st.ptr);
                     return false;
                 }
-                st.optName = it->second;
-                if (st.optName.flags & fNameFinal)
+                st.optName = found;
+                if (st.optName->flags & fNameFinal)
                     st.moreOpts = false;
 
-                if (!st.optName.opt->m_bool) {
+                if (!st.optName->opt->m_bool) {
                     // Short name option that takes a value, which might be
                     // attached as the rest of the argument. Adjust pointer to
                     // the attached value, or set it to null if none.
@@ -2168,7 +3346,7 @@ bool Cli::OptIndex::parseToRawValues(
                         st.ptr = nullptr;
                     // Since that value consumes the rest of the argument,
                     // process it and then advance to next argument.
-                    if (!parseOptionValue(out, st, cli, args))
+                    if (!parseOptionValue(out, st, cli, argc, argv))
                         return false;
                     goto NEXT_ARG;
                 }
@@ -2178,7 +3356,7 @@ bool Cli::OptIndex::parseToRawValues(
                 addOptionMatch(
                     out,
                     st,
-                    (st.optName.flags & fNameInvert) ? "0" : "1"
+                    (st.optName->flags & fNameInvert) ? "0" : "1"
                 );
             }
             if (!*st.ptr) {
@@ -2195,30 +3373,30 @@ bool Cli::OptIndex::parseToRawValues(
                 st.moreOpts = false;
                 continue;
             }
+            string_view name;
             if (auto equal = strchr(st.ptr, '=')) {
                 // Name is everything up to the equal sign, value is rest of
                 // the arg after it.
-                st.name.assign(st.ptr, equal - st.ptr);
+                name = {st.ptr, size_t(equal - st.ptr)};
                 st.ptr = equal + 1;
             } else {
                 // No equal sign, everything is name, there is no value.
-                st.name = st.ptr;
+                name = st.ptr;
                 st.ptr = nullptr;
             }
-            auto it = m_longNames.find(st.name);
-            st.name.insert(0, "--");
-            if (it == m_longNames.end()) {
-                cli.badUsage("Unknown option", st.name);
+            auto found = st.ndx->findLongName(name);
+            if (!found) {
+                cli.badUsage("Unknown option", "--" + string(name));
                 return false;
             }
-            st.optName = it->second;
-            if (st.optName.flags & fNameFinal)
+            st.optName = found;
+            if (st.optName->flags & fNameFinal)
                 st.moreOpts = false;
 
-            if (!st.optName.opt->m_bool) {
+            if (!st.optName->opt->m_bool) {
                 // Long option with (possibly empty) value, process it and
                 // advance to next argument.
-                if (!parseOptionValue(out, st, cli, args))
+                if (!parseOptionValue(out, st, cli, argc, argv))
                     return false;
                 continue;
             }
@@ -2226,18 +3404,21 @@ bool Cli::OptIndex::parseToRawValues(
             // Found bool long name.
             auto val = true;
             if (st.ptr
-                && (st.optName.opt->m_flagValue || !parseBool(val, st.ptr))
+                && (st.optName->opt->m_flagValue || !parseBool(val, st.ptr))
             ) {
                 // Only regular bool opts support values, and those values
                 // must be valid: true, false, 1, 0, y, n, etc.
-                cli.badUsage("Invalid '" + st.name + "' value", st.ptr);
+                cli.badUsage(
+                    "Invalid '" + *st.optName->from + "' value",
+                    st.ptr
+                );
                 return false;
             }
             // Record and advance to the next argument.
             addOptionMatch(
                 out,
                 st,
-                val == bool(st.optName.flags & fNameInvert) ? "0" : "1"
+                val == bool(st.optName->flags & fNameInvert) ? "0" : "1"
             );
             continue;
         }
@@ -2260,13 +3441,14 @@ bool Cli::OptIndex::parseToRawValues(
             out->data() + st.precmdValues,
             out->size() - st.precmdValues,
             cli,
-            *this,
+            *st.ndx,
             st.numOprs
         )) {
             return false;
         }
     }
 
+    *ndx = move(st.ndx);
     return true;
 }
 
@@ -2295,22 +3477,25 @@ static bool badMinMatched(
     return false;
 }
 
+//===========================================================================
+static bool badMaxMatched(
+    Cli & cli,
+    const Cli::OptBase & opt,
+    const string & name,
+    string_view val
+) {
+    string prefix = "Too many '" + name + "' values";
+    string detail = "The maximum number of values is "
+        + intToString(opt, opt.maxSize()) + ".";
+    cli.badUsage(prefix, string(val), detail);
+    return false;
+}
+
 //===========================================================================
 bool Cli::parse(vector<string> & args) {
     Config::touchAllCmds(*this);
     resetValues();
 
-    OptIndex ndx;
-    ndx.index(*this, "", false);
-
-    if (commandRequired(*m_cfg) && !ndx.m_allowCommands) {
-        // Command processing requires that the command be unambiguously
-        // identifiable and can't be used when the top level has an operand
-        // that requires look ahead to match. Which is caused by the first
-        // operand being either optional or a variable length vector.
-        assert(!"Mixing top level optional operands with commands.");
-    }
-
     // Preprocess arguments and verify that at least one exists.
     if (!args.empty()) {
 #if !defined(DIMCLI_LIB_NO_ENV)
@@ -2337,8 +3522,56 @@ bool Cli::parse(vector<string> & args) {
                 break;
         }
     }
+    auto argv = toPtrArgv(args);
+    return parseArgs(argv.size(), argv.data());
+}
+
+//===========================================================================
+bool Cli::parse(vector<string> && args) {
+    m_cfg->ownedArgs = &args;
+    auto success = parse(args);
+    m_cfg->ownedArgs = nullptr;
+    return success;
+}
+
+//===========================================================================
+bool Cli::parse(size_t argc, char * argv[]) {
+    // Copy the arguments if they might need to be modified before parsing.
+    bool copy = !m_cfg->befores.empty();
+#if !defined(DIMCLI_LIB_NO_ENV)
+    if (m_cfg->envOpts.size() && getenv(m_cfg->envOpts.c_str()))
+        copy = true;
+#endif
+#ifdef DIMCLI_LIB_FILESYSTEM
+    if (m_cfg->responseFiles) {
+        for (size_t i = 0; i < argc && !copy; ++i)
+            copy = *argv[i] == '@';
+    }
+#endif
+    if (copy)
+        return parse(toArgv(argc, argv));
+
+    if (argc && argv[argc])
+        assert(!"Bad arguments, argc and null terminator don't agree.");
+    Config::touchAllCmds(*this);
+    resetValues();
+    return parseArgs(argc, argv);
+}
+
+//===========================================================================
+bool Cli::parseArgs(size_t argc, const char * const argv[]) {
+    auto ndx = Config::findIndex(*this, "", false);
+
+    if (commandRequired(*m_cfg) && !ndx->m_allowCommands) {
+        // Command processing requires that the command be unambiguously
+        // identifiable and can't be used when the top level has an operand
+        // that requires look ahead to match. Which is caused by the first
+        // operand being either optional or a variable length vector.
+        assert(!"Mixing top level optional operands with commands.");
+    }
+
     // The 0th argument (name of this program) must always be present.
-    if (args.empty()) {
+    if (!argc) {
         assert(!"At least one argument (the program name) required.");
         fail(kExitSoftware, "No arguments (not even program name) provided.");
         return false;
@@ -2346,25 +3579,50 @@ bool Cli::parse(vector<string> & args) {
 
     // Extract raw values and match them to opts.
     vector<RawValue> rawValues;
-    if (!ndx.parseToRawValues(&rawValues, args, *this))
+    if (!OptIndex::parseToRawValues(&rawValues, &ndx, argc, argv, *this))
         return false;
 
-    // Parse values and copy them to defined opts.
+    // Count the values going to each option, so vector options can make room
+    // for all of theirs at once.
+    vector<size_t> counts(m_cfg->opts.size());
+    vector<OptBase *> matched;
+    for (auto && val : rawValues) {
+        if (val.opt && !counts[val.opt->m_slot]++)
+            matched.push_back(val.opt);
+    }
+    for (auto && opt : matched) {
+        if (counts[opt->m_slot] > 1)
+            opt->reserveValues(counts[opt->m_slot]);
+    }
+
+    // Parse values and copy them to defined opts. Values of parallel options
+    // are left pending and converted together at the next command, or the
+    // end, unless the parse fails first.
+    const auto kAllPending = numeric_limits<size_t>::max();
     m_cfg->command = "";
     for (auto && val : rawValues) {
         switch (val.type) {
         case RawValue::kCommand:
-            m_cfg->command = val.name;
+            if (!convertPending(matched, kAllPending))
+                return false;
+            m_cfg->command = *val.name;
             continue;
         default:
             break;
         }
-        if (!parseValue(*val.opt, val.name, val.pos, val.ptr))
+        m_cfg->allowPending = true;
+        if (!parseMatch(*val.opt, val.name, val.pos, val.ptr)) {
+            // An invalid pending value from an earlier argument is reported
+            // instead, since parsing would have stopped there.
+            convertPending(matched, val.pos);
             return false;
+        }
     }
+    if (!convertPending(matched, kAllPending))
+        return false;
 
     // Report operands and options with too few values.
-    for (auto && oprName : ndx.m_oprNames) {
+    for (auto && oprName : ndx->m_oprNames) {
         auto & opt = *oprName.opt;
         if (~oprName.flags & fNameOptional) {
             // Report required operands that are missing.
@@ -2372,22 +3630,20 @@ bool Cli::parse(vector<string> & args) {
                 return badMinMatched(*this, opt, oprName.name);
         }
     }
-    for (auto && nv : ndx.m_shortNames) {
-        auto & opt = *nv.second.opt;
+    for (auto && nv : ndx->m_shortNames) {
+        auto & opt = *nv.opt;
         if (opt && opt.size() < (size_t) opt.minSize())
             return badMinMatched(*this, opt);
     }
-    for (auto && nv : ndx.m_longNames) {
-        auto & opt = *nv.second.opt;
+    for (auto && nv : ndx->m_longNames) {
+        auto & opt = *nv.opt;
         if (opt && opt.size() < (size_t) opt.minSize())
             return badMinMatched(*this, opt);
     }
 
     // After actions
-    for (auto && opt : m_cfg->opts) {
-        if (!ndx.includeOptAfter(*opt, commandMatched())) {
-            continue;
-        }
+    auto afters = Config::findAfterOpts(*this, commandMatched());
+    for (auto && opt : *afters) {
         opt->doAfterActions(*this);
         if (parseAborted())
             return false;
@@ -2397,20 +3653,95 @@ bool Cli::parse(vector<string> & args) {
 }
 
 //===========================================================================
-bool Cli::parse(vector<string> && args) {
-    return parse(args);
+bool Cli::convertPending(const vector<OptBase *> & opts, size_t limit) {
+    const OptBase * bad = {};
+    ArgMatch badMatch;
+    string badValue;
+    for (auto && opt : opts) {
+        ArgMatch match;
+        string value;
+        if (!opt->convertPending(&match, &value, limit)
+            && (!bad || match.pos < badMatch.pos)
+        ) {
+            bad = opt;
+            badMatch = match;
+            badValue = move(value);
+        }
+    }
+    if (!bad)
+        return true;
+    m_cfg->badDeferred(*bad, badMatch, badValue);
+    return false;
 }
 
 //===========================================================================
-bool Cli::parse(size_t argc, char * argv[]) {
-    auto args = toArgv(argc, argv);
-    return parse(move(args));
+// static
+size_t Cli::convertChunks(
+    size_t count,
+    unsigned maxThreads,
+    const locale & loc,
+    const function<ChunkFn> & fn
+) {
+    auto chunks = count / kMinParallelChunk;
+    if (!maxThreads)
+        maxThreads = thread::hardware_concurrency();
+    chunks = min(chunks, (size_t) maxThreads);
+    if (chunks < 2) {
+        Convert cvt(loc);
+        return fn(cvt, 0, count);
+    }
+
+    // Each chunk reports its own first failure, or exception, the earliest
+    // chunk with one has the first failure overall. Exceptions are rethrown
+    // on this thread, since letting them escape a thread would terminate.
+    vector<size_t> bads(chunks, count);
+    vector<exception_ptr> errs(chunks);
+    auto convert = [&](size_t chunk) {
+        try {
+            Convert cvt(loc);
+            auto first = count * chunk / chunks;
+            auto last = count * (chunk + 1) / chunks;
+            auto bad = fn(cvt, first, last);
+            if (bad != last)
+                bads[chunk] = bad;
+        } catch (...) {
+            errs[chunk] = current_exception();
+        }
+    };
+    vector<thread> threads;
+    threads.reserve(chunks - 1);
+    for (size_t i = 1; i < chunks; ++i) {
+        try {
+            threads.emplace_back(convert, i);
+        } catch (const system_error &) {
+            // No more threads, the rest are converted on this one.
+            break;
+        }
+    }
+    convert(0);
+    for (auto i = threads.size() + 1; i < chunks; ++i)
+        convert(i);
+    for (auto && t : threads)
+        t.join();
+    for (size_t i = 0; i < chunks; ++i) {
+        if (errs[i])
+            rethrow_exception(errs[i]);
+        if (bads[i] != count)
+            return bads[i];
+    }
+    return count;
 }
 
 //===========================================================================
 Cli & Cli::resetValues() & {
-    for (auto && opt : m_cfg->opts)
-        opt->reset();
+    m_cfg->resetsSkipped = 0;
+    for (auto && opt : m_cfg->opts) {
+        if (opt->dirty()) {
+            opt->reset();
+        } else {
+            m_cfg->resetsSkipped += 1;
+        }
+    }
     m_cfg->parseExit = false;
     m_cfg->exitCode = kExitOk;
     m_cfg->errMsg.clear();
@@ -2426,6 +3757,33 @@ Cli && Cli::resetValues() && {
     return move(resetValues());
 }
 
+//===========================================================================
+size_t Cli::resetsSkipped() const {
+    return m_cfg->resetsSkipped;
+}
+
+//===========================================================================
+bool Cli::validate() {
+    const OptBase * bad = {};
+    ArgMatch badMatch;
+    string badValue;
+    for (auto && opt : m_cfg->opts) {
+        ArgMatch match;
+        string value;
+        if (!opt->convertDeferred(&match, &value)
+            && (!bad || match.pos < badMatch.pos)
+        ) {
+            bad = opt.get();
+            badMatch = match;
+            badValue = move(value);
+        }
+    }
+    if (!bad)
+        return true;
+    m_cfg->badDeferred(*bad, badMatch, badValue);
+    return false;
+}
+
 
 /****************************************************************************
 *
@@ -2439,17 +3797,7 @@ void Cli::badUsage(
     const string & value,
     const string & detail
 ) {
-    string out;
-    auto & cmd = commandMatched();
-    if (cmd.size())
-        out = "Command '" + cmd + "': ";
-    out += prefix;
-    if (!value.empty()) {
-        out += ": ";
-        out += value;
-    }
-    fail(kExitUsage, out, detail);
-    m_cfg->parseExit = true;
+    m_cfg->badUsage(prefix, value, detail);
 }
 
 //===========================================================================
@@ -2477,23 +3825,71 @@ bool Cli::parseValue(
     size_t pos,
     const char ptr[]
 ) {
-    if (!opt.match(name, pos)) {
-        string prefix = "Too many '" + name + "' values";
-        string detail = "The maximum number of values is "
-            + intToString(opt, opt.maxSize()) + ".";
-        badUsage(prefix, ptr, detail);
-        return false;
-    }
-    string val;
+    return parseMatch(opt, m_cfg->intern(name), pos, ptr);
+}
+
+//===========================================================================
+bool Cli::parseMatch(
+    OptBase & opt,
+    const string * name,
+    size_t pos,
+    const char ptr[]
+) {
+    bool pending = exchange(m_cfg->allowPending, false);
+    if (!opt.match(name, pos))
+        return badMaxMatched(*this, opt, *name, ptr ? ptr : "");
+    string_view val;
     if (ptr) {
+        // Take whole arguments that are owned by the parser by move, if the
+        // option allows it, otherwise parse them.
+        auto args = m_cfg->ownedArgs;
+        if (args
+            && pos < args->size()
+            && (*args)[pos].data() == ptr
+            && opt.moveValue((*args)[pos])
+        ) {
+            if (parseAborted())
+                return false;
+            opt.sinkValue(*this);
+            return !parseAborted();
+        }
         val = ptr;
+        m_cfg->allowPending = pending;
+        bool deferred = opt.deferValue(val);
+        m_cfg->allowPending = false;
+        if (!deferred) {
+            opt.doParseAction(*this, val);
+            if (parseAborted())
+                return false;
+        }
+    } else {
+        opt.assignImplicit();
+    }
+    opt.doCheckActions(*this, val);
+    if (parseAborted())
+        return false;
+    opt.sinkValue(*this);
+    return !parseAborted();
+}
+
+//===========================================================================
+bool Cli::parseListEntry(
+    OptBase & opt,
+    const string * name,
+    size_t pos,
+    string_view val
+) {
+    if (!opt.match(name, pos))
+        return badMaxMatched(*this, opt, *name, val);
+    if (!opt.deferValue(val)) {
         opt.doParseAction(*this, val);
         if (parseAborted())
             return false;
-    } else {
-        opt.assignImplicit();
     }
     opt.doCheckActions(*this, val);
+    if (parseAborted())
+        return false;
+    opt.sinkValue(*this);
     return !parseAborted();
 }
 
@@ -2605,8 +4001,9 @@ bool Cli::parseAborted() const {
 //===========================================================================
 bool Cli::exec() {
     auto & name = commandMatched();
-    auto & cmdFn = commandExists(name)
-        ? m_cfg->cmds[name].action
+    auto cmd = m_cfg->cmds.find(name);
+    auto & cmdFn = cmd != m_cfg->cmds.end()
+        ? cmd->second.action
         : m_cfg->unknownCmd;
     if (!cmdFn) {
         // Most likely parse failed, was never run, or "this" was reset.
@@ -2643,10 +4040,7 @@ bool Cli::exec(vector<string> & args) {
 
 //===========================================================================
 void Cli::fail(int code, const string & msg, const string & detail) {
-    m_cfg->parseExit = false;
-    m_cfg->exitCode = code;
-    m_cfg->errMsg = format(*m_cfg, msg);
-    m_cfg->errDetail = format(*m_cfg, detail);
+    m_cfg->fail(code, msg, detail);
 }
 
 //===========================================================================
@@ -2715,36 +4109,36 @@ string Cli::OptIndex::nameDescList(
     unsigned flags = 0;
 
     // Names
-    vector<const decltype(m_shortNames)::value_type *> snames;
+    vector<const OptName *> snames;
     for (auto & sn : m_shortNames)
         snames.push_back(&sn);
     sort(snames.begin(), snames.end(), [](auto & a, auto & b) {
-        return a->second.pos < b->second.pos;
+        return a->pos < b->pos;
     });
     for (auto && sn : snames) {
-        if (!includeName(sn->second, type, opt, opt.m_bool, opt.inverted()))
+        if (!includeName(*sn, type, opt, opt.m_bool, opt.inverted()))
             continue;
-        flags = sn->second.flags;
+        flags = sn->flags;
         if (!list.empty())
             list += ", ";
         list += '-';
-        list += sn->first;
+        list += sn->name;
     }
-    vector<const decltype(m_longNames)::value_type *> lnames;
+    vector<const OptName *> lnames;
     for (auto & ln : m_longNames)
         lnames.push_back(&ln);
     sort(lnames.begin(), lnames.end(), [](auto & a, auto & b) {
-        return a->second.pos < b->second.pos;
+        return a->pos < b->pos;
     });
     for (auto && ln : lnames) {
-        if (!includeName(ln->second, type, opt, opt.m_bool, opt.inverted()))
+        if (!includeName(*ln, type, opt, opt.m_bool, opt.inverted()))
             continue;
-        flags = ln->second.flags;
+        flags = ln->flags;
         if (!list.empty())
             list += ", ";
         foundLong = true;
         list += "--";
-        list += ln->first;
+        list += ln->name;
     }
     if (opt.m_bool || list.empty())
         return list;
@@ -2810,40 +4204,6 @@ vector<OptKey> Cli::OptIndex::findNamedOpts(
 *
 ***/
 
-namespace {
-
-struct ChoiceKey {
-    size_t pos;
-    const char * key;
-    const char * desc;
-    const char * sortKey;
-    bool def;
-};
-
-} // namespace
-
-//===========================================================================
-static vector<ChoiceKey> getChoiceKeys(
-    const unordered_map<string, Cli::OptBase::ChoiceDesc> & choices
-) {
-    vector<ChoiceKey> out;
-    for (auto && cd : choices) {
-        ChoiceKey key;
-        key.pos = cd.second.pos;
-        key.key = cd.first.c_str();
-        key.desc = cd.second.desc.c_str();
-        key.sortKey = cd.second.sortKey.c_str();
-        key.def = cd.second.def;
-        out.push_back(key);
-    }
-    sort(out.begin(), out.end(), [](auto & a, auto & b) {
-        if (int rc = strcmp(a.sortKey, b.sortKey))
-            return rc < 0;
-        return a.pos < b.pos;
-    });
-    return out;
-}
-
 //===========================================================================
 static void writeNbsp(string * out, const string & str) {
     for (auto ch : str)
@@ -2853,45 +4213,53 @@ static void writeNbsp(string * out, const string & str) {
 //===========================================================================
 static void writeChoices(
     string * outPtr,
-    const unordered_map<string, Cli::OptBase::ChoiceDesc> & choices
+    const Cli::OptBase::ChoiceTable & choices
 ) {
     auto & out = *outPtr;
-    if (choices.empty())
-        return;
-    auto keys = getChoiceKeys(choices);
     const size_t indent = 6;
 
-    string desc;
     string prefix(indent, ' ');
-    for (auto && k : keys) {
+    for (auto && cd : choices.help) {
         out += prefix;
-        writeNbsp(&out, k.key);
+        writeNbsp(&out, cd->first);
         out += '\t';
-        out += k.desc;
-        if (k.def)
+        out += cd->second.desc;
+        if (cd->second.def)
             out += " (default)";
         out += '\n';
     }
 }
 
 //===========================================================================
+// Lists the choices the value could have been, which is all of them unless
+// it's an ambiguous prefix. Only the first kMaxChoicesDetail are named.
 static void writeChoicesDetail(
     string * outPtr,
-    const unordered_map<string, Cli::OptBase::ChoiceDesc> & choices
+    const Cli::OptBase::ChoiceTable & choices,
+    string_view val
 ) {
     auto & out = *outPtr;
-    if (choices.empty())
+    if (choices.help.empty())
         return;
-    out += "Must be";
-    auto keys = getChoiceKeys(choices);
+    auto keys = choices.prefixMatches(val);
+    if (keys.empty()) {
+        out += "Must be";
+        keys = choices.help;
+    } else {
+        out += "Ambiguous, could be";
+    }
 
-    string val;
-    size_t pos = 0;
-    auto num = keys.size();
-    for (auto i = keys.begin(); pos < num; ++pos, ++i) {
-        out += " '";
-        writeNbsp(&out, i->key);
-        out += "'";
+    auto shown = min(keys.size(), kMaxChoicesDetail);
+    auto others = keys.size() - shown;
+    auto num = shown + (others ? 1 : 0);
+    for (size_t pos = 0; pos < num; ++pos) {
+        if (pos < shown) {
+            out += " '";
+            writeNbsp(&out, keys[pos]->first);
+            out += "'";
+        } else {
+            out += " one of " + to_string(others) + " others";
+        }
         if (pos == 0 && num == 2) {
             out += " or";
         } else if (pos + 1 == num) {
@@ -2916,8 +4284,7 @@ static void writeUsage(
         return;
     auto & out = *outPtr;
     auto & cfg = Cli::Config::get(cli);
-    Cli::OptIndex ndx;
-    ndx.index(cli, cmdName, true);
+    auto ndx = Cli::Config::findIndex(cli, cmdName, true);
     auto prog = displayName(arg0.empty() ? cli.progName() : arg0);
     auto prefix = "Usage: " + prog;
     out.append(prefix.size() + 1, '\v');
@@ -2926,12 +4293,12 @@ static void writeUsage(
         out += ' ';
         out += cmdName;
     }
-    if (!ndx.m_shortNames.empty() || !ndx.m_longNames.empty()) {
+    if (!ndx->m_shortNames.empty() || !ndx->m_longNames.empty()) {
         if (!expandedOptions) {
             out += " [OPTIONS]";
         } else {
             auto & cmd = Cli::Config::findCmdAlways(cli, cmdName);
-            auto namedOpts = ndx.findNamedOpts(
+            auto namedOpts = ndx->findNamedOpts(
                 cli,
                 cmd,
                 kNameNonDefault,
@@ -2950,7 +4317,7 @@ static void writeUsage(
     } else if (!cli.commandExists(cmdName)) {
         out += " [ARGS...]";
     } else {
-        for (auto && pa : ndx.m_oprNames) {
+        for (auto && pa : ndx->m_oprNames) {
             out += ' ';
             string token = pa.name.find(' ') == string::npos
                 ? pa.name
@@ -3118,9 +4485,10 @@ string Cli::OptIndex::desc(
 
 //===========================================================================
 // static
-const unordered_map<string, Cli::OptBase::ChoiceDesc> &
-Cli::OptIndex::choiceDescs(const OptBase & opt) {
-    return opt.m_choiceDescs;
+const Cli::OptBase::ChoiceTable & Cli::OptIndex::choices(
+    const OptBase & opt
+) {
+    return opt.choiceTable();
 }
 
 //===========================================================================
@@ -3128,11 +4496,10 @@ void Cli::printOperands(string * outPtr, const string & cmd) {
     if (!outPtr)
         return;
     auto & out = *outPtr;
-    Cli::OptIndex ndx;
-    ndx.index(*this, cmd, true);
+    auto ndx = Cli::Config::findIndex(*this, cmd, true);
     bool hasDesc = false;
-    for (auto && pa : ndx.m_oprNames) {
-        if (!ndx.desc(*pa.opt, false).empty()) {
+    for (auto && pa : ndx->m_oprNames) {
+        if (!ndx->desc(*pa.opt, false).empty()) {
             hasDesc = true;
             break;
         }
@@ -3141,13 +4508,13 @@ void Cli::printOperands(string * outPtr, const string & cmd) {
         return;
 
     out += '\f';
-    for (auto && pa : ndx.m_oprNames) {
+    for (auto && pa : ndx->m_oprNames) {
         out += "  \v\v";
         writeNbsp(&out, pa.name);
         out += '\t';
-        out += ndx.desc(*pa.opt);
+        out += ndx->desc(*pa.opt);
         out += '\n';
-        writeChoices(&out, ndx.choiceDescs(*pa.opt));
+        writeChoices(&out, ndx->choices(*pa.opt));
     }
 }
 
@@ -3156,12 +4523,11 @@ void Cli::printOptions(string * outPtr, const string & cmdName) {
     if (!outPtr)
         return;
     auto & out = *outPtr;
-    Cli::OptIndex ndx;
-    ndx.index(*this, cmdName, true);
+    auto ndx = Cli::Config::findIndex(*this, cmdName, true);
     auto & cmd = Cli::Config::findCmdAlways(*this, cmdName);
 
     // Find named args and the longest name list.
-    auto namedOpts = ndx.findNamedOpts(*this, cmd, kNameAll, false);
+    auto namedOpts = ndx->findNamedOpts(*this, cmd, kNameAll, false);
     if (namedOpts.empty())
         return;
 
@@ -3191,9 +4557,9 @@ void Cli::printOptions(string * outPtr, const string & cmdName) {
         out += indent;
         out += key.list;
         out += '\t';
-        out += ndx.desc(*key.opt);
+        out += ndx->desc(*key.opt);
         out += '\n';
-        writeChoices(&out, ndx.choiceDescs(*key.opt));
+        writeChoices(&out, ndx->choices(*key.opt));
     }
 }
 
@@ -4247,6 +5613,17 @@ string Cli::toWindowsCmdline(const vector<string> & args) {
 *
 ***/
 
+// Also used by the file mapping API below.
+#if defined(_WIN32)
+#pragma pack(push)
+#pragma pack()
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#define UNICODE
+#include <Windows.h>
+#pragma pack(pop)
+#endif
+
 #if defined(DIMCLI_LIB_NO_CONSOLE)
 
 //===========================================================================
@@ -4263,14 +5640,6 @@ unsigned Cli::consoleWidth(bool /* queryWidth */) {
 
 #elif defined(_WIN32)
 
-#pragma pack(push)
-#pragma pack()
-#define WIN32_LEAN_AND_MEAN
-#define NOMINMAX
-#define UNICODE
-#include <Windows.h>
-#pragma pack(pop)
-
 //===========================================================================
 bool Cli::consoleEnableEcho(bool enable) {
     auto hInput = GetStdHandle(STD_INPUT_HANDLE);
@@ -4335,3 +5704,86 @@ unsigned Cli::consoleWidth(bool queryWidth) {
 }
 
 #endif
+
+
+/****************************************************************************
+*
+*   Native file mapping API
+*
+***/
+
+#if defined(_WIN32)
+
+//===========================================================================
+MappedFile::~MappedFile() {
+    if (m_base)
+        UnmapViewOfFile(m_base);
+}
+
+//===========================================================================
+bool MappedFile::open(const string & path) {
+    auto file = CreateFileA(
+        path.c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_FLAG_SEQUENTIAL_SCAN,
+        nullptr
+    );
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER size = {};
+    bool success = GetFileType(file) == FILE_TYPE_DISK
+        && GetFileSizeEx(file, &size);
+    if (success && size.QuadPart) {
+        // The view keeps the mapping, and the file, open until it's unmapped.
+        auto map = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, {});
+        if (map) {
+            m_base = (const char *) MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(map);
+        }
+        success = m_base;
+        if (success)
+            m_len = (size_t) size.QuadPart;
+    }
+    CloseHandle(file);
+    return success;
+}
+
+#else
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//===========================================================================
+MappedFile::~MappedFile() {
+    if (m_base)
+        munmap((void *) m_base, m_len);
+}
+
+//===========================================================================
+bool MappedFile::open(const string & path) {
+    auto fd = ::open(path.c_str(), O_RDONLY);
+    if (fd == -1)
+        return false;
+    struct stat st = {};
+    bool success = !fstat(fd, &st) && S_ISREG(st.st_mode);
+    if (success && st.st_size) {
+        // The mapping keeps the file open until it's unmapped.
+        auto len = (size_t) st.st_size;
+        auto base = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+        success = base != MAP_FAILED;
+        if (success) {
+            madvise(base, len, MADV_SEQUENTIAL);
+            m_base = (const char *) base;
+            m_len = len;
+        }
+    }
+    close(fd);
+    return success;
+}
+
+#endif
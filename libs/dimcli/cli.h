@@ -124,15 +124,21 @@
 *
 ***/
 
+#include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <cmath>
 #include <cstddef>
 #include <functional>
+#include <initializer_list>
+#include <iterator>
 #include <limits>
 #include <list>
 #include <memory>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -155,6 +161,16 @@
 #endif
 #endif
 
+#if defined(__has_include)
+#if __has_include(<charconv>)
+#include <charconv>
+#endif
+#endif
+// std::from_chars and std::to_chars with support for floating point types.
+#if defined(__cpp_lib_to_chars)
+#define DIMCLI_LIB_CHARCONV
+#endif
+
 
 namespace Dim {
 
@@ -193,12 +209,14 @@ class DIMCLI_LIB_DECL Cli {
 public:
     struct Config;
     class Convert;
+    template <typename T> class RangeList;
 
     class OptBase;
     template <typename A, typename T> class OptShim;
     template <typename T> class Opt;
     template <typename T> class OptVec;
     struct OptIndex;
+    struct UnitTable;
 
     struct ArgMatch;
     template <typename T> struct Value;
@@ -486,6 +504,16 @@ public:
     Cli & responseFiles(bool enable = true) &;
     Cli && responseFiles(bool enable = true) &&;
 
+    // Makes opt.lazy() the default for options added after it's called.
+    Cli & lazyValues(bool enable = true) &;
+    Cli && lazyValues(bool enable = true) &&;
+
+    // Maximum number of threads used to convert the values of options with
+    // optVec.parallel(), including the one parsing. Defaults to 0, for one
+    // per core.
+    Cli & maxThreads(unsigned threads) &;
+    Cli && maxThreads(unsigned threads) &&;
+
     // Changes the streams used for prompting, printing help messages, etc.
     // Mainly intended for testing. Setting to null restores the defaults
     // which are cin and cout respectively.
@@ -521,18 +549,36 @@ public:
     //
     // Error information can be extracted after cli.parse() completes, see
     // cli.errMsg() and friends.
+    //
+    // The arguments are parsed in place, they're only copied if environment
+    // options, response files, or before actions need to modify them.
     [[nodiscard]] bool parse(size_t argc, char * argv[]);
 
     // "args" is non-const so that response files can be expanded in place and
     // to allow it to be modified by before actions.
     [[nodiscard]] bool parse(std::vector<std::string> & args);
+    // When given ownership of the arguments, string and path options take
+    // their values from them by move.
     [[nodiscard]] bool parse(std::vector<std::string> && args);
 
     // Sets all options to their defaults, called internally when parsing
-    // starts.
+    // starts. Options whose values are known to still be at their defaults
+    // are skipped, which are those bound to internal variables that haven't
+    // been parsed or accessed through the non-const *opt, opt->, etc since
+    // they were last reset.
     Cli & resetValues() &;
     Cli && resetValues() &&;
 
+    // Number of options skipped by the last cli.resetValues() because they
+    // were already set to their defaults.
+    size_t resetsSkipped() const;
+
+    // Converts the values of lazy options, see opt.lazy(), that haven't yet
+    // been accessed. Returns false and, as with cli.parse(), sets the
+    // exitCode and error message if any of them fail, reporting the one
+    // earliest in argv.
+    [[nodiscard]] bool validate();
+
     //-----------------------------------------------------------------------
     // Support functions for use from parsing actions
 
@@ -597,6 +643,18 @@ public:
         fUnitBinaryPrefix = 4,
     };
 
+    // fChoice* flags modify how values are matched with the choices added
+    // by opt.choice(), see opt.choiceFlags(). An exact match is always
+    // preferred.
+    enum {
+        // Matches choices regardless of case.
+        fChoiceInsensitive = 1,
+
+        // Also matches a prefix of exactly one of the choices, such as "ver"
+        // for "verbose".
+        fChoicePrefix = 2,
+    };
+
     // Prompt sends a prompt message to cout and read a response from cin
     // (unless cli.iostreams() changed the streams to use), the response is
     // then passed to cli.parseValue() to set the value and run any actions.
@@ -940,7 +998,7 @@ private:
     static void defParseAction(
         Cli & cli,
         OptBase & opt,
-        const std::string & val
+        std::string_view val
     );
     static void requireAction(
         Cli & cli,
@@ -953,10 +1011,33 @@ private:
 
     static std::string fixCmdName(const std::string & name);
 
-    static std::vector<std::pair<std::string, double>> siUnitMapping(
+    // True for std::chrono durations and time points.
+    template <typename R, typename P>
+    static constexpr bool timeType(std::chrono::duration<R, P> *) {
+        return true;
+    }
+    template <typename C, typename D>
+    static constexpr bool timeType(std::chrono::time_point<C, D> *) {
+        return true;
+    }
+    static constexpr bool timeType(const void *) { return false; }
+
+    // True for lists of integer ranges.
+    template <typename T>
+    static constexpr bool rangeListType(RangeList<T> *) { return true; }
+    static constexpr bool rangeListType(const void *) { return false; }
+
+    // Unit tables are immutable and interned, options configured with the
+    // same units and flags share a single table.
+    static std::shared_ptr<const UnitTable> unitTable(
+        const std::vector<std::pair<std::string, long double>> & units,
+        int flags
+    );
+    static std::shared_ptr<const UnitTable> siUnitTable(
         const std::string & symbol,
         int flags
     );
+    static std::shared_ptr<const UnitTable> timeUnitTable(int flags);
 
     void addOpt(std::unique_ptr<OptBase> opt);
     template <typename A> A & addOpt(std::unique_ptr<A> ptr);
@@ -967,6 +1048,56 @@ private:
     // Find an option (from any subcommand) that targets the value.
     OptBase * findOpt(const void * value);
 
+    // Same as cli.parseValue() except that the name must already be interned.
+    bool parseMatch(
+        OptBase & out,
+        const std::string * name,
+        size_t pos,
+        const char src[]
+    );
+
+    // Same as parseMatch() except that the value is an entry of a list file
+    // (see optVec.fromListFile()), so it's neither moved from nor left
+    // pending.
+    bool parseListEntry(
+        OptBase & out,
+        const std::string * name,
+        size_t pos,
+        std::string_view value
+    );
+
+    // Maps or reads the list file, or stdin if the path is "-", and parses
+    // each of its entries as a value of the option.
+    bool parseListFile(
+        OptBase & out,
+        const OptBase & src,
+        std::string_view path
+    );
+
+    // Converts the values of the options that were left to be converted in
+    // parallel, for arguments before argv[limit]. Reports the first failure,
+    // in argv order, and returns false if any fail.
+    bool convertPending(const std::vector<OptBase *> & opts, size_t limit);
+
+    // Calls fn for consecutive chunks of [0, count), on up to maxThreads
+    // threads (0 for one per core) if there are enough, each with its own
+    // converter using the locale. Each call returns the index of its first
+    // failure, or 'last' if none failed. Returns the first failure overall,
+    // or count if there were none. An exception thrown by fn is rethrown,
+    // after all the calls have finished, on the calling thread. Chunks that
+    // a thread can't be started for are converted on the calling thread.
+    using ChunkFn = size_t(const Convert & cvt, size_t first, size_t last);
+    static size_t convertChunks(
+        size_t count,
+        unsigned maxThreads,
+        const std::locale & loc,
+        const std::function<ChunkFn> & fn
+    );
+
+    // Parses arguments that have already been preprocessed (environment
+    // options, response files, and before actions).
+    bool parseArgs(size_t argc, const char * const argv[]);
+
     std::shared_ptr<Config> m_cfg;
     std::string m_group;
     std::string m_command;
@@ -1057,7 +1188,7 @@ void Cli::badRange(
 template <typename A>
 A & Cli::addOpt(std::unique_ptr<A> ptr) {
     auto & opt = *ptr;
-    opt.parse(&Cli::defParseAction).command(command()).group(group());
+    opt.parseView(&Cli::defParseAction).command(command()).group(group());
     addOpt(std::unique_ptr<OptBase>(ptr.release()));
     return opt;
 }
@@ -1084,6 +1215,10 @@ std::string Cli::valueDesc() {
         return "NUM";
     } else if (std::is_floating_point<T>::value) {
         return "FLOAT";
+    } else if (timeType((T *) nullptr)) {
+        return "DURATION";
+    } else if (rangeListType((T *) nullptr)) {
+        return "RANGES";
     } else if (std::is_convertible<T, std::string>::value) {
         return "STRING";
     } else {
@@ -1126,19 +1261,188 @@ public:
 
 class DIMCLI_LIB_DECL Cli::Convert {
 public:
+    Convert();
+    // Converts using the locale, such as the one of an option.
+    explicit Convert(const std::locale & loc);
+
     // Converts from string to T.
     template <typename T>
     [[nodiscard]] bool fromString(T & out, const std::string & value) const;
 
+    // Converts from a view of the string to T, this is what the default
+    // parse action uses. Types that can be assigned from a string_view or
+    // converted with std::from_chars are converted directly, everything else
+    // goes through fromString(T&, const std::string&). Specialize it, such
+    // as with the following, to parse a type without a temporary string:
+    //  template<> bool Cli::Convert::fromString<MyType>(
+    //      MyType & out, std::string_view src) const { ... }
+    template <typename T>
+    [[nodiscard]] bool fromString(T & out, std::string_view value) const;
+    template <typename T>
+    [[nodiscard]] bool fromString(T & out, const char value[]) const;
+
+    // Durations, and time points as offsets from the epoch of their clock,
+    // are numbers followed by units: y (365d), w, d, h, min or m (minute),
+    // s, ms, us, or ns. Units can be combined, as in "1h30m", and a number
+    // without units counts ticks of the duration's own period. Integral
+    // durations are computed exactly, rounded to the nearest tick, and fail
+    // if the result doesn't fit.
+    template <typename Rep, typename Period>
+    [[nodiscard]] bool fromString(
+        std::chrono::duration<Rep, Period> & out,
+        std::string_view value
+    ) const;
+    template <typename Rep, typename Period>
+    [[nodiscard]] bool fromString(
+        std::chrono::duration<Rep, Period> & out,
+        const std::string & value
+    ) const;
+    template <typename Clock, typename Duration>
+    [[nodiscard]] bool fromString(
+        std::chrono::time_point<Clock, Duration> & out,
+        std::string_view value
+    ) const;
+    template <typename Clock, typename Duration>
+    [[nodiscard]] bool fromString(
+        std::chrono::time_point<Clock, Duration> & out,
+        const std::string & value
+    ) const;
+
+    // Range lists are comma separated values and inclusive ranges of values,
+    // such as "1-5,8,-3--1". The ranges can be in any order and may overlap.
+    template <typename T>
+    [[nodiscard]] bool fromString(
+        RangeList<T> & out,
+        std::string_view value
+    ) const;
+    template <typename T>
+    [[nodiscard]] bool fromString(
+        RangeList<T> & out,
+        const std::string & value
+    ) const;
+
     // Converts to string from T. Sets to empty string and returns false if
     // conversion fails or no conversion available.
     template <typename T>
     [[nodiscard]] bool toString(std::string & out, const T & src) const;
 
+    // Durations and time points are written in the largest unit that
+    // represents them exactly, such as "90s" or "1500ms".
+    template <typename Rep, typename Period>
+    [[nodiscard]] bool toString(
+        std::string & out,
+        const std::chrono::duration<Rep, Period> & src
+    ) const;
+    template <typename Clock, typename Duration>
+    [[nodiscard]] bool toString(
+        std::string & out,
+        const std::chrono::time_point<Clock, Duration> & src
+    ) const;
+
+    // Range lists are written in order with the ranges merged, such as
+    // "-3--1,1-5,8".
+    template <typename T>
+    [[nodiscard]] bool toString(
+        std::string & out,
+        const RangeList<T> & src
+    ) const;
+
 protected:
-    mutable std::stringstream m_interpreter;
+    // Changes the locale of the interpreter.
+    std::locale imbueInterpreter(const std::locale & loc);
+
+    // Returns the stream used to convert types without a faster path,
+    // creating it with the interpreter's locale on first use.
+    std::stringstream & interpreter() const;
+
+    // Locale of the interpreter, applied to the stream when it's created.
+    std::locale m_locale;
 
 private:
+    mutable std::unique_ptr<std::stringstream> m_interpreter;
+
+    // Numbers (other than bools and characters) are converted with
+    // std::from_chars when the locale of the interpreter doesn't change what
+    // it would accept, falling back to the interpreter if it fails.
+    template <typename T>
+    static constexpr bool charconvType() {
+        return std::is_floating_point<T>::value
+            || (std::is_integral<T>::value
+                && !std::is_same<T, bool>::value
+                && !std::is_same<T, char>::value
+                && !std::is_same<T, signed char>::value
+                && !std::is_same<T, unsigned char>::value
+                && !std::is_same<T, wchar_t>::value
+#if defined(__cpp_char8_t)
+                && !std::is_same<T, char8_t>::value
+#endif
+                && !std::is_same<T, char16_t>::value
+                && !std::is_same<T, char32_t>::value);
+    }
+
+    template <typename T, typename = typename
+        std::enable_if<charconvType<T>()>::type>
+    bool fromChars(T & out, std::string_view src, int) const;
+    template <typename T>
+    bool fromChars(T & out, std::string_view src, long) const;
+
+    // Uses std::to_chars, which for floating point gives the shortest
+    // representation that round trips, when the locale of the interpreter
+    // wouldn't change the result.
+    template <typename T, typename = typename
+        std::enable_if<charconvType<T>()>::type>
+    bool toChars(std::string & out, const T & src, int) const;
+    template <typename T>
+    bool toChars(std::string & out, const T & src, long) const;
+
+    // Result of parsing a duration, as both the exact number of ticks,
+    // rounded to nearest, and an approximation for floating point counts.
+    struct DurationCount {
+        uintmax_t count;
+        long double approx;
+        bool neg;
+        bool overflow; // count doesn't fit in uintmax_t
+    };
+
+    // Parses a duration into ticks that are each num/den seconds.
+    static bool parseDuration(
+        DurationCount * out,
+        std::string_view src,
+        intmax_t num,
+        intmax_t den
+    );
+    // Writes ticks that are each num/den seconds using the largest unit that
+    // represents them exactly.
+    static void formatDuration(
+        std::string & out,
+        bool neg,
+        uintmax_t count,
+        intmax_t num,
+        intmax_t den
+    );
+    // Returns the name of the unit that is num/den seconds, or an empty
+    // string if there isn't one.
+    static std::string_view durationUnit(intmax_t num, intmax_t den);
+
+    template <typename Rep, typename Period, typename = typename
+        std::enable_if<std::is_integral<Rep>::value>::type>
+    static bool durationValue(
+        std::chrono::duration<Rep, Period> & out,
+        const DurationCount & src,
+        int
+    );
+    template <typename Rep, typename Period>
+    static bool durationValue(
+        std::chrono::duration<Rep, Period> & out,
+        const DurationCount & src,
+        long
+    );
+
+    // True if the locale of the interpreter uses '.' as its decimal point.
+    bool m_charconv = {};
+    // True if it also doesn't group digits.
+    bool m_tochars = {};
+
     template <typename T>
     auto fromString_impl(T & out, const std::string & src, int, int, int) const
         -> decltype(out = src, bool());
@@ -1165,6 +1469,17 @@ private:
         long, long, long
     ) const;
 
+    template <typename T>
+    auto fromView_impl(T & out, std::string_view src, int, int) const
+        -> decltype(out = src, bool());
+
+    template <typename T, typename = typename
+        std::enable_if<charconvType<T>()>::type>
+    bool fromView_impl(T & out, std::string_view src, int, long) const;
+
+    template <typename T>
+    bool fromView_impl(T & out, std::string_view src, long, long) const;
+
     template <typename T>
     auto toString_impl(std::string & out, const T & src, int) const
         -> decltype(std::declval<std::ostream &>() << src, bool());
@@ -1219,9 +1534,12 @@ auto Cli::Convert::fromString_impl(
 ) const
     -> decltype(std::declval<std::istream &>() >> out, bool())
 {
-    m_interpreter.clear();
-    m_interpreter.str(src);
-    if (!(m_interpreter >> out) || !(m_interpreter >> std::ws).eof()) {
+    if (fromChars(out, src, 0))
+        return true;
+    auto & is = interpreter();
+    is.clear();
+    is.str(src);
+    if (!(is >> out) || !(is >> std::ws).eof()) {
         out = {};
         return false;
     }
@@ -1248,6 +1566,193 @@ bool Cli::Convert::fromString_impl(
     return false;
 }
 
+//===========================================================================
+template <typename T>
+[[nodiscard]] bool Cli::Convert::fromString(
+    T & out,
+    std::string_view src
+) const {
+    return fromView_impl(out, src, 0, 0);
+}
+
+//===========================================================================
+template <typename T>
+[[nodiscard]] bool Cli::Convert::fromString(
+    T & out,
+    const char src[]
+) const {
+    return fromString(out, std::string_view(src));
+}
+
+//===========================================================================
+template <typename Rep, typename Period>
+[[nodiscard]] bool Cli::Convert::fromString(
+    std::chrono::duration<Rep, Period> & out,
+    std::string_view src
+) const {
+    DurationCount dc;
+    if (!parseDuration(&dc, src, Period::num, Period::den))
+        return false;
+    return durationValue(out, dc, 0);
+}
+
+//===========================================================================
+template <typename Rep, typename Period>
+[[nodiscard]] bool Cli::Convert::fromString(
+    std::chrono::duration<Rep, Period> & out,
+    const std::string & src
+) const {
+    return fromString(out, std::string_view(src));
+}
+
+//===========================================================================
+template <typename Clock, typename Duration>
+[[nodiscard]] bool Cli::Convert::fromString(
+    std::chrono::time_point<Clock, Duration> & out,
+    std::string_view src
+) const {
+    Duration offset;
+    if (!fromString(offset, src))
+        return false;
+    out = std::chrono::time_point<Clock, Duration>(offset);
+    return true;
+}
+
+//===========================================================================
+template <typename Clock, typename Duration>
+[[nodiscard]] bool Cli::Convert::fromString(
+    std::chrono::time_point<Clock, Duration> & out,
+    const std::string & src
+) const {
+    return fromString(out, std::string_view(src));
+}
+
+//===========================================================================
+template <typename Rep, typename Period, typename>
+bool Cli::Convert::durationValue(
+    std::chrono::duration<Rep, Period> & out,
+    const DurationCount & src,
+    int
+) {
+    using D = std::chrono::duration<Rep, Period>;
+    constexpr auto high = (uintmax_t) std::numeric_limits<Rep>::max();
+    if (src.overflow)
+        return false;
+    if (!src.neg || !src.count) {
+        if (src.count > high)
+            return false;
+        out = D(Rep(src.count));
+        return true;
+    }
+    if (!std::is_signed<Rep>::value || src.count - 1 > high)
+        return false;
+    // Negated in two steps, so the lowest value doesn't overflow.
+    out = D(Rep(-Rep(src.count - 1) - 1));
+    return true;
+}
+
+//===========================================================================
+template <typename Rep, typename Period>
+bool Cli::Convert::durationValue(
+    std::chrono::duration<Rep, Period> & out,
+    const DurationCount & src,
+    long
+) {
+    using D = std::chrono::duration<Rep, Period>;
+    out = D(Rep(src.neg ? -src.approx : src.approx));
+    return true;
+}
+
+//===========================================================================
+template <typename T>
+auto Cli::Convert::fromView_impl(
+    T & out,
+    std::string_view src,
+    int, int
+) const
+    -> decltype(out = src, bool())
+{
+    out = src;
+    return true;
+}
+
+//===========================================================================
+template <typename T, typename>
+bool Cli::Convert::fromView_impl(
+    T & out,
+    std::string_view src,
+    int, long
+) const {
+    if (fromChars(out, src, 0))
+        return true;
+    return fromString(out, std::string(src));
+}
+
+//===========================================================================
+template <typename T>
+bool Cli::Convert::fromView_impl(
+    T & out,
+    std::string_view src,
+    long, long
+) const {
+    return fromString(out, std::string(src));
+}
+
+//===========================================================================
+template <typename T, typename>
+bool Cli::Convert::fromChars(T & out, std::string_view src, int) const {
+#ifdef DIMCLI_LIB_CHARCONV
+    if (!m_charconv)
+        return false;
+    auto first = src.data();
+    auto last = first + src.size();
+    if (std::is_floating_point<T>::value) {
+        // Leave infinity, NaN, and anything else that isn't digits to the
+        // interpreter.
+        auto ptr = first + (first < last && *first == '-');
+        if (ptr == last || (*ptr != '.' && (*ptr < '0' || *ptr > '9')))
+            return false;
+    }
+    T tmp;
+    auto res = std::from_chars(first, last, tmp);
+    if (res.ec != std::errc{} || res.ptr != last)
+        return false;
+    out = tmp;
+    return true;
+#else
+    return false;
+#endif
+}
+
+//===========================================================================
+template <typename T>
+bool Cli::Convert::fromChars(T &, std::string_view, long) const {
+    return false;
+}
+
+//===========================================================================
+template <typename T, typename>
+bool Cli::Convert::toChars(std::string & out, const T & src, int) const {
+#ifdef DIMCLI_LIB_CHARCONV
+    if (!m_tochars)
+        return false;
+    char buf[64];
+    auto res = std::to_chars(buf, buf + sizeof buf, src);
+    if (res.ec != std::errc{})
+        return false;
+    out.assign(buf, res.ptr);
+    return true;
+#else
+    return false;
+#endif
+}
+
+//===========================================================================
+template <typename T>
+bool Cli::Convert::toChars(std::string &, const T &, long) const {
+    return false;
+}
+
 //===========================================================================
 template <typename T>
 [[nodiscard]] bool Cli::Convert::toString(
@@ -1257,6 +1762,43 @@ template <typename T>
     return toString_impl(out, src, 0);
 }
 
+//===========================================================================
+template <typename Rep, typename Period>
+[[nodiscard]] bool Cli::Convert::toString(
+    std::string & out,
+    const std::chrono::duration<Rep, Period> & src
+) const {
+    auto count = src.count();
+    if (std::is_integral<Rep>::value) {
+        auto neg = count < Rep{};
+        auto mag = neg ? 0 - (uintmax_t) count : (uintmax_t) count;
+        formatDuration(out, neg, mag, Period::num, Period::den);
+        return true;
+    }
+
+    auto unit = durationUnit(Period::num, Period::den);
+    if (unit.empty()) {
+        auto secs = std::chrono::duration<long double>(src);
+        if (!toString(out, secs.count()))
+            return false;
+        out += 's';
+    } else {
+        if (!toString(out, count))
+            return false;
+        out += unit;
+    }
+    return true;
+}
+
+//===========================================================================
+template <typename Clock, typename Duration>
+[[nodiscard]] bool Cli::Convert::toString(
+    std::string & out,
+    const std::chrono::time_point<Clock, Duration> & src
+) const {
+    return toString(out, src.time_since_epoch());
+}
+
 //===========================================================================
 template <typename T>
 auto Cli::Convert::toString_impl(
@@ -1266,13 +1808,16 @@ auto Cli::Convert::toString_impl(
 ) const
     -> decltype(std::declval<std::ostream &>() << src, bool())
 {
-    m_interpreter.clear();
-    m_interpreter.str({});
-    if (!(m_interpreter << src)) {
+    if (toChars(out, src, 0))
+        return true;
+    auto & os = interpreter();
+    os.clear();
+    os.str({});
+    if (!(os << src)) {
         out.clear();
         return false;
     }
-    out = m_interpreter.str();
+    out = os.str();
     return true;
 }
 
@@ -1287,40 +1832,361 @@ bool Cli::Convert::toString_impl(
     return false;
 }
 
-
-/****************************************************************************
-*
-*   Cli
-*
-*   Additional members that must come after Cli::Convert is fully declared.
-*
-***/
-
-//===========================================================================
-template <typename ...Args>
-std::vector<std::string> Cli::toArgvL(Args &&... args) {
-    std::string tmp;
-    Convert cvt;
-    std::vector<std::string> out = {
-        ((void) cvt.toString(tmp, std::forward<Args>(args)), tmp)...
-    };
-    return out;
-}
-
 //===========================================================================
-template <typename ...Args>
-std::string Cli::toCmdlineL(Args &&... args) {
-    return toCmdline(toArgvL(std::forward<Args>(args)...));
+template <typename T>
+[[nodiscard]] bool Cli::Convert::fromString(
+    RangeList<T> & out,
+    std::string_view src
+) const {
+    out.clear();
+    for (;;) {
+        auto comma = src.find(',');
+        auto item = src.substr(0, comma);
+        // The low value may be negative, so its sign isn't the separator.
+        auto dash = item.find('-', 1);
+        T low;
+        T high;
+        if (!fromString(low, item.substr(0, dash)))
+            return false;
+        if (dash == item.npos) {
+            high = low;
+        } else if (!fromString(high, item.substr(dash + 1)) || high < low) {
+            return false;
+        }
+        out.insert(low, high);
+        if (comma == src.npos)
+            return true;
+        src.remove_prefix(comma + 1);
+    }
 }
 
 //===========================================================================
-template <typename ...Args>
-std::string Cli::toGlibCmdlineL(Args &&... args) {
-    return toGlibCmdline(toArgvL(std::forward<Args>(args)...));
+template <typename T>
+[[nodiscard]] bool Cli::Convert::fromString(
+    RangeList<T> & out,
+    const std::string & src
+) const {
+    return fromString(out, std::string_view(src));
 }
 
 //===========================================================================
-template <typename ...Args>
+template <typename T>
+[[nodiscard]] bool Cli::Convert::toString(
+    std::string & out,
+    const RangeList<T> & src
+) const {
+    out.clear();
+    std::string tmp;
+    for (auto && r : src.ranges()) {
+        if (!out.empty())
+            out += ',';
+        if (!toString(tmp, r.low))
+            return false;
+        out += tmp;
+        if (r.high != r.low) {
+            if (!toString(tmp, r.high))
+                return false;
+            out += '-';
+            out += tmp;
+        }
+    }
+    return true;
+}
+
+
+/****************************************************************************
+*
+*   Cli::RangeList
+*
+*   Set of integers kept as sorted inclusive ranges, such as a selection of
+*   shards given as "0-99999,150000-199999". Iterating, contains(), and size()
+*   work from the ranges without expanding them into their values.
+*
+***/
+
+template <typename T>
+class Cli::RangeList {
+    // Character types are excluded, since they're converted as characters
+    // rather than as numbers.
+    static_assert(
+        std::is_integral<T>::value
+            && !std::is_same<T, bool>::value
+            && !std::is_same<T, char>::value
+            && !std::is_same<T, signed char>::value
+            && !std::is_same<T, unsigned char>::value
+            && !std::is_same<T, wchar_t>::value
+#if defined(__cpp_char8_t)
+            && !std::is_same<T, char8_t>::value
+#endif
+            && !std::is_same<T, char16_t>::value
+            && !std::is_same<T, char32_t>::value,
+        "RangeList values must be integers"
+    );
+
+public:
+    using value_type = T;
+
+    // Inclusive range of values.
+    struct Range {
+        T low;
+        T high;
+
+        bool operator==(const Range & other) const {
+            return low == other.low && high == other.high;
+        }
+    };
+
+    // Visits each value of each range in ascending order.
+    class iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T *;
+        using reference = const T &;
+
+        iterator() = default;
+        const T & operator*() const { return m_value; }
+        iterator & operator++();
+        iterator operator++(int);
+        bool operator==(const iterator & other) const;
+        bool operator!=(const iterator & other) const;
+
+    private:
+        friend class RangeList;
+        iterator(const Range * pos, const Range * end);
+
+        const Range * m_pos = {};
+        const Range * m_end = {};
+        T m_value = {};
+    };
+
+public:
+    RangeList() = default;
+    RangeList(std::initializer_list<Range> ranges);
+
+    // Adds the values from low to high, inclusive, merging them with any
+    // ranges they overlap or adjoin.
+    void insert(T low, T high);
+    void insert(T value) { insert(value, value); }
+
+    // Removes the values that are outside of low to high.
+    void clamp(T low, T high);
+    void clear() { m_ranges.clear(); }
+
+    bool contains(T value) const;
+    bool empty() const { return m_ranges.empty(); }
+
+    // Number of values, limited to the largest uintmax_t.
+    uintmax_t size() const;
+
+    // Lowest and highest values, the list must not be empty.
+    T front() const { return m_ranges.front().low; }
+    T back() const { return m_ranges.back().high; }
+
+    // Ranges in ascending order, none of them overlap or adjoin.
+    const std::vector<Range> & ranges() const { return m_ranges; }
+
+    iterator begin() const;
+    iterator end() const;
+
+    bool operator==(const RangeList & other) const;
+    bool operator!=(const RangeList & other) const;
+
+private:
+    std::vector<Range> m_ranges;
+};
+
+//===========================================================================
+template <typename T>
+Cli::RangeList<T>::RangeList(std::initializer_list<Range> ranges) {
+    for (auto && r : ranges)
+        insert(r.low, r.high);
+}
+
+//===========================================================================
+template <typename T>
+void Cli::RangeList<T>::insert(T low, T high) {
+    if (high < low)
+        assert(!"Bad range, low greater than high.");
+
+    // First range that isn't entirely before, and apart from, the new one.
+    // The additions can't overflow, since they're only made to values that
+    // are less than others.
+    auto first = std::lower_bound(
+        m_ranges.begin(),
+        m_ranges.end(),
+        low,
+        [](auto & r, T val) { return r.high < val && r.high + 1 < val; }
+    );
+    auto last = first;
+    while (last != m_ranges.end()
+        && (last->low <= high || last->low - 1 == high)
+    ) {
+        ++last;
+    }
+    if (first == last) {
+        m_ranges.insert(first, {low, high});
+        return;
+    }
+    first->low = std::min(first->low, low);
+    first->high = std::max(std::prev(last)->high, high);
+    m_ranges.erase(first + 1, last);
+}
+
+//===========================================================================
+template <typename T>
+void Cli::RangeList<T>::clamp(T low, T high) {
+    if (high < low)
+        assert(!"Bad clamp, low greater than high.");
+    auto first = std::find_if(
+        m_ranges.begin(),
+        m_ranges.end(),
+        [low](auto & r) { return r.high >= low; }
+    );
+    auto last = std::find_if(
+        first,
+        m_ranges.end(),
+        [high](auto & r) { return r.low > high; }
+    );
+    m_ranges.erase(last, m_ranges.end());
+    m_ranges.erase(m_ranges.begin(), first);
+    if (!m_ranges.empty()) {
+        m_ranges.front().low = std::max(m_ranges.front().low, low);
+        m_ranges.back().high = std::min(m_ranges.back().high, high);
+    }
+}
+
+//===========================================================================
+template <typename T>
+bool Cli::RangeList<T>::contains(T value) const {
+    auto i = std::upper_bound(
+        m_ranges.begin(),
+        m_ranges.end(),
+        value,
+        [](T val, auto & r) { return val < r.low; }
+    );
+    return i != m_ranges.begin() && value <= std::prev(i)->high;
+}
+
+//===========================================================================
+template <typename T>
+uintmax_t Cli::RangeList<T>::size() const {
+    const auto kMax = std::numeric_limits<uintmax_t>::max();
+    uintmax_t out = 0;
+    for (auto && r : m_ranges) {
+        // Unsigned wrap around gives the distance even when low is negative.
+        // Only a range of every uintmax_t wraps to zero.
+        auto num = (uintmax_t) r.high - (uintmax_t) r.low + 1;
+        if (!num || num > kMax - out)
+            return kMax;
+        out += num;
+    }
+    return out;
+}
+
+//===========================================================================
+template <typename T>
+typename Cli::RangeList<T>::iterator Cli::RangeList<T>::begin() const {
+    return iterator(m_ranges.data(), m_ranges.data() + m_ranges.size());
+}
+
+//===========================================================================
+template <typename T>
+typename Cli::RangeList<T>::iterator Cli::RangeList<T>::end() const {
+    auto last = m_ranges.data() + m_ranges.size();
+    return iterator(last, last);
+}
+
+//===========================================================================
+template <typename T>
+bool Cli::RangeList<T>::operator==(const RangeList & other) const {
+    return m_ranges == other.m_ranges;
+}
+
+//===========================================================================
+template <typename T>
+bool Cli::RangeList<T>::operator!=(const RangeList & other) const {
+    return !(*this == other);
+}
+
+//===========================================================================
+template <typename T>
+Cli::RangeList<T>::iterator::iterator(const Range * pos, const Range * end)
+    : m_pos(pos)
+    , m_end(end)
+{
+    if (m_pos != m_end)
+        m_value = m_pos->low;
+}
+
+//===========================================================================
+template <typename T>
+auto Cli::RangeList<T>::iterator::operator++() -> iterator & {
+    if (m_value != m_pos->high) {
+        ++m_value;
+    } else if (++m_pos != m_end) {
+        m_value = m_pos->low;
+    } else {
+        m_value = {};
+    }
+    return *this;
+}
+
+//===========================================================================
+template <typename T>
+auto Cli::RangeList<T>::iterator::operator++(int) -> iterator {
+    auto out = *this;
+    ++*this;
+    return out;
+}
+
+//===========================================================================
+template <typename T>
+bool Cli::RangeList<T>::iterator::operator==(const iterator & other) const {
+    return m_pos == other.m_pos && m_value == other.m_value;
+}
+
+//===========================================================================
+template <typename T>
+bool Cli::RangeList<T>::iterator::operator!=(const iterator & other) const {
+    return !(*this == other);
+}
+
+
+/****************************************************************************
+*
+*   Cli
+*
+*   Additional members that must come after Cli::Convert is fully declared.
+*
+***/
+
+//===========================================================================
+template <typename ...Args>
+std::vector<std::string> Cli::toArgvL(Args &&... args) {
+    std::string tmp;
+    Convert cvt;
+    std::vector<std::string> out = {
+        ((void) cvt.toString(tmp, std::forward<Args>(args)), tmp)...
+    };
+    return out;
+}
+
+//===========================================================================
+template <typename ...Args>
+std::string Cli::toCmdlineL(Args &&... args) {
+    return toCmdline(toArgvL(std::forward<Args>(args)...));
+}
+
+//===========================================================================
+template <typename ...Args>
+std::string Cli::toGlibCmdlineL(Args &&... args) {
+    return toGlibCmdline(toArgvL(std::forward<Args>(args)...));
+}
+
+//===========================================================================
+template <typename ...Args>
 std::string Cli::toGnuCmdlineL(Args &&... args) {
     return toGnuCmdline(toArgvL(std::forward<Args>(args)...));
 }
@@ -1356,6 +2222,9 @@ public:
         size_t pos = {};
         bool def = {};
     };
+    // Choices sorted for lookup and for help text, built once configuration
+    // is complete.
+    struct ChoiceTable;
 
 public:
     OptBase(const std::string & names, bool flag);
@@ -1419,18 +2288,76 @@ public:
     virtual void reset() = 0;
 
     // Parse the string into the value, return false on error.
-    [[nodiscard]] virtual bool parseValue(const std::string & value) = 0;
+    [[nodiscard]] virtual bool parseValue(std::string_view value) = 0;
 
 protected:
     virtual bool defaultValueToString(std::string & out) const = 0;
     virtual std::string defaultValueDesc() const = 0;
 
-    virtual void doParseAction(Cli & cli, const std::string & value) = 0;
-    virtual void doCheckActions(Cli & cli, const std::string & value) = 0;
+    virtual void doParseAction(Cli & cli, std::string_view value) = 0;
+    virtual void doCheckActions(Cli & cli, std::string_view value) = 0;
     virtual void doAfterActions(Cli & cli) = 0;
 
-    // Record the command line argument that this opt matched with.
-    virtual bool match(const std::string & name, size_t pos) = 0;
+    // True if the value might not be what opt.reset() would set it to.
+    virtual bool dirty() const = 0;
+
+    // Takes the argument by move instead of parsing a copy of it, if the
+    // value is a string or path and only the default parse action applies.
+    // Returns false, leaving the argument untouched, otherwise.
+    virtual bool moveValue(std::string & value) = 0;
+
+    // Saves the argument to be converted on first access, returns false if
+    // the option doesn't defer conversion (see opt.lazy()).
+    virtual bool deferValue(std::string_view value) = 0;
+
+    // Converts values whose conversion was deferred. If any fail, returns
+    // false with the match and value of the first one.
+    virtual bool convertDeferred(
+        ArgMatch * badMatch,
+        std::string * badValue
+    ) const = 0;
+
+    // Converts deferred values when they're accessed, conversion errors are
+    // reported to the cli. Returns false if any failed.
+    bool convertOnAccess() const;
+
+    // Makes room for the number of values about to be parsed, so that vector
+    // options grow once instead of one value at a time.
+    virtual void reserveValues(size_t count) { (void) count; }
+
+    // Hands the value that was just parsed and checked to the sink of the
+    // option, if it has one (see optVec.sink()).
+    virtual void sinkValue(Cli & cli) { (void) cli; }
+
+    // Converts values that were left until the end of the parse, so they
+    // could be split between threads (see optVec.parallel()). Values from
+    // argv[limit] or later are skipped. If any fail, returns false with the
+    // match and value of the first one.
+    virtual bool convertPending(
+        ArgMatch * badMatch,
+        std::string * badValue,
+        size_t limit
+    ) {
+        (void) badMatch, (void) badValue, (void) limit;
+        return true;
+    }
+
+    // True while the cli is matching a value taken directly from the command
+    // line, which stays valid until the end of the parse, when values left
+    // pending are converted.
+    bool pendingAllowed() const;
+
+    // Maximum number of threads to convert pending values with, see
+    // cli.maxThreads().
+    unsigned maxThreads() const;
+
+    // Adds an option that takes the name of a file listing values for this
+    // one (see optVec.fromListFile()).
+    void addListFileOpt(const std::string & names);
+
+    // Record the command line argument that this opt matched with. The name
+    // is interned by the cli and stays valid for as long as it does.
+    virtual bool match(const std::string * name, size_t pos) = 0;
     virtual bool matched() const = 0;
 
     // Assign the implicit value to the value. Used when an option, with an
@@ -1447,17 +2374,46 @@ protected:
 
     void setNameIfEmpty(const std::string & name);
 
-    bool withUnits(
-        long double & out,
+    // Discards the cached indexes of the cli this option belongs to, called
+    // by modifiers that change how the option is indexed.
+    void indexChanged();
+
+    // Splits the value into its number and units suffix. Reports bad usage
+    // and returns false if there's no number.
+    bool splitUnits(
+        std::string_view * number,
+        std::string_view * unit,
         Cli & cli,
-        const std::string & val,
-        const std::unordered_map<std::string, long double> & units,
+        std::string_view val
+    ) const;
+
+    // Gets the multiplier for the units suffix, which is 1 if there's no
+    // suffix. Reports bad usage and returns false if the suffix isn't
+    // recognized, or is missing and fUnitRequire was given.
+    bool unitsFactor(
+        long double * factor,
+        Cli & cli,
+        std::string_view val,
+        std::string_view unit,
+        const UnitTable & units,
         int flags
     ) const;
 
+    // Returns the choice matching the value, or null if there isn't exactly
+    // one.
+    const ChoiceDesc * findChoice(std::string_view value) const;
+
+    // Returns the lookup table of the choices, building it if it was
+    // discarded by changes to the choices.
+    const ChoiceTable & choiceTable() const;
+
     std::string m_command;
     std::string m_group;
 
+    // Option added by fromListFile(), which follows this one into the
+    // commands and groups it's moved to.
+    OptBase * m_listFileOpt = {};
+
     bool m_visible = true;  // Whether the opt appears in help text.
     std::string m_nameDesc;
     std::string m_desc;
@@ -1467,6 +2423,8 @@ protected:
     std::unique_ptr<std::string> m_defaultDesc;
 
     std::unordered_map<std::string, ChoiceDesc> m_choiceDescs;
+    int m_choiceFlags = {}; // Cli::fChoice* flags
+    mutable std::shared_ptr<const ChoiceTable> m_choiceTable;
 
     // Whether this option has one value or a vector of values.
     bool m_vector = {};
@@ -1482,11 +2440,31 @@ protected:
     bool m_flagValue = {};
     bool m_flagDefault = {};
 
+    // Whether any after actions have been added.
+    bool m_hasAfters = {};
+
+    // Whether conversion of values is deferred until they're accessed.
+    bool m_lazy = {};
+
+    // Returned by opt.from() when there's no matched argument.
+    std::string m_empty;
+
 private:
     friend class Cli;
 
-    std::string m_names;
+    // Names parsed from the name specification given to the constructor.
+    struct NameToken {
+        std::string name;
+        unsigned flags;
+        int pos;
+    };
+    std::vector<NameToken> m_nameTokens;
     std::string m_fromName;
+
+    // Configuration this option was added to, null until it's added.
+    Config * m_cfg = {};
+    // Position in the list of options of that configuration.
+    size_t m_slot = {};
 };
 
 
@@ -1575,6 +2553,10 @@ public:
         const std::string & sortKey = {}
     );
 
+    // Changes how values are matched with the choices, such as ignoring case
+    // or allowing abbreviations.
+    A & choiceFlags(int flags); // Cli::fChoice* flags
+
     // Normalizes the value by removing the symbol and if SI unit prefixes
     // (such as u, m, k, M, G, ki, Mi, and Gi) are present, multiplying the
     // value by the corresponding factor and removing it as well. The
@@ -1612,10 +2594,35 @@ public:
     // (inclusive) of low to high.
     A & range(const T & low, const T & high);
 
+    // For range lists, such as Opt<RangeList<int>> or OptVec<RangeList<int>>,
+    // the bounds apply to each value in the list. Values outside of them are
+    // removed by clamp(), and fail the parse with range().
+    template <typename U = T>
+    auto clamp(
+        const typename U::value_type & low,
+        const typename U::value_type & high
+    ) -> typename std::enable_if<rangeListType((U *) nullptr), A &>::type;
+    template <typename U = T>
+    auto range(
+        const typename U::value_type & low,
+        const typename U::value_type & high
+    ) -> typename std::enable_if<rangeListType((U *) nullptr), A &>::type;
+
     // Causes a check whether the option value was set during parsing, and
     // reports cli.badUsage() if it wasn't.
     A & require();
 
+    // Defers converting arguments to values until they're first accessed
+    // via *opt, opt->, or opt[], or cli.validate() is called. Errors found
+    // on access are reported to the cli the same as by cli.validate(), and
+    // leave a default constructed value. For non-vector options only the
+    // last argument is kept, earlier ones are converted when they're replaced
+    // so their errors are still reported by the parse.
+    //
+    // Ignored by options with check actions, flag values, or values bound
+    // to external variables, and unless the default parse action is used.
+    A & lazy(bool enable = true);
+
     // Enables prompting. When the option hasn't been provided on the command
     // line the user will be prompted for it. Use Cli::fPrompt* flags to
     // adjust behavior.
@@ -1628,6 +2635,10 @@ public:
     // Function signature of actions that are tied to options.
     using ActionFn = void(Cli & cli, A & opt, const std::string & val);
 
+    // Signature of parse actions that get a view of the argument instead of
+    // a copy of it.
+    using ViewActionFn = void(Cli & cli, A & opt, std::string_view val);
+
     // Change the action to take when parsing this argument. The function
     // should:
     //  - Parse the val string and use the result to set the value (or, for
@@ -1645,6 +2656,10 @@ public:
     // the default parse action will pick it up.
     A & parse(std::function<ActionFn> fn);
 
+    // Same as parse(), but the function gets a view of the argument instead
+    // of it first being copied to a std::string.
+    A & parseView(std::function<ViewActionFn> fn);
+
     // Action to take immediately after each value is parsed, unlike parsing
     // itself where there can only be one action, any number of check actions
     // can be added. They will be called in the order they were added and if
@@ -1679,8 +2694,8 @@ public:
 
 protected:
     std::string defaultValueDesc() const final;
-    void doParseAction(Cli & cli, const std::string & value) final;
-    void doCheckActions(Cli & cli, const std::string & value) final;
+    void doParseAction(Cli & cli, std::string_view value) final;
+    void doCheckActions(Cli & cli, std::string_view value) final;
     void doAfterActions(Cli & cli) final;
     void act(
         Cli & cli,
@@ -1692,12 +2707,79 @@ protected:
     // If numeric_limits<T>::min & max are defined and 'x' is outside of
     // those limits badRange() is called, otherwise returns true.
     template <typename U>
-    auto checkLimits(Cli & cli, const std::string & val, const U & x, int)
+    auto checkLimits(Cli & cli, std::string_view val, const U & x, int)
         -> decltype((U) std::declval<T&>() > x);
     template <typename U>
-    bool checkLimits(Cli & cli, const std::string & val, const U & x, long);
+    bool checkLimits(Cli & cli, std::string_view val, const U & x, long);
+
+    // Installs the parse action that applies the units table.
+    A & unitsAction(std::shared_ptr<const UnitTable> units, int flags);
+
+    // Sets the value from a number with units. Numbers are converted
+    // directly to arithmetic types, with exact integer math when both the
+    // number and the multiplier of the units are integers. Other types get
+    // the result in the form of a string.
+    template <typename U = T>
+    auto unitsValue(
+        Cli & cli,
+        std::string_view val,
+        std::string_view number,
+        std::string_view unit,
+        const UnitTable & units,
+        int flags,
+        int
+    ) -> typename std::enable_if<
+        std::is_arithmetic<U>::value && !std::is_same<U, bool>::value
+    >::type;
+    template <typename U = T>
+    void unitsValue(
+        Cli & cli,
+        std::string_view val,
+        std::string_view number,
+        std::string_view unit,
+        const UnitTable & units,
+        int flags,
+        long
+    );
+    static void assignValue(Opt<T> & opt, const T & value) {
+        *opt = value;
+    }
+    static void assignValue(OptVec<T> & opt, const T & value) {
+        opt->back() = value;
+    }
+
+    // Value most recently parsed.
+    static T & lastValue(Opt<T> & opt) { return *opt; }
+    static T & lastValue(OptVec<T> & opt) { return opt->back(); }
+
+    // True if the default parse action is being used.
+    bool defaultParse() const;
+
+    // True if values may be moved from the argument by moveValue().
+    bool movable() const;
+
+    // True if conversion of values may be deferred by deferValue().
+    bool deferrable() const;
+
+    // True if values may be converted apart from parsing, because only the
+    // default parse action applies and there are no checks.
+    bool convertible() const;
+
+    // Converts using the choices, if there are any, otherwise fromString()
+    // of the converter.
+    bool convertValue(T & out, std::string_view value) const;
+    bool convertValue(
+        T & out,
+        std::string_view value,
+        const Convert & cvt
+    ) const;
+    template <typename U>
+    static auto moveString(U && out, std::string & src, int)
+        -> decltype(out = std::move(src), bool());
+    template <typename U>
+    static bool moveString(U && out, std::string & src, long);
 
-    std::function<ActionFn> m_parse;
+    std::function<ViewActionFn> m_parse;
     std::vector<std::function<ActionFn>> m_checks;
     std::vector<std::function<ActionFn>> m_afters;
 
@@ -1725,7 +2807,7 @@ inline std::string Cli::OptShim<A, T>::defaultValueDesc() const {
 template <typename A, typename T>
 inline void Cli::OptShim<A, T>::doParseAction(
     Cli & cli,
-    const std::string & val
+    std::string_view val
 ) {
     auto self = static_cast<A *>(this);
     m_parse(cli, *self, val);
@@ -1735,9 +2817,11 @@ inline void Cli::OptShim<A, T>::doParseAction(
 template <typename A, typename T>
 inline void Cli::OptShim<A, T>::doCheckActions(
     Cli & cli,
-    const std::string & val
+    std::string_view val
 ) {
-    act(cli, val, m_checks);
+    // Only make a string of the value if there's someone to give it to.
+    if (!m_checks.empty())
+        act(cli, std::string(val), m_checks);
 }
 
 //===========================================================================
@@ -1761,6 +2845,86 @@ inline void Cli::OptShim<A, T>::act(
     }
 }
 
+//===========================================================================
+template <typename A, typename T>
+bool Cli::OptShim<A, T>::defaultParse() const {
+    using DefFn = void(*)(Cli &, OptBase &, std::string_view);
+    auto fn = m_parse.template target<DefFn>();
+    return fn && *fn == &Cli::defParseAction;
+}
+
+//===========================================================================
+template <typename A, typename T>
+bool Cli::OptShim<A, T>::movable() const {
+    bool stringLike = std::is_same<T, std::string>::value;
+#ifdef DIMCLI_LIB_FILESYSTEM
+    stringLike = stringLike
+        || std::is_same<T, DIMCLI_LIB_FILESYSTEM_PATH>::value;
+#endif
+    if (!stringLike
+        || this->m_flagValue
+        || !m_choices.empty()
+        || !m_checks.empty()
+    ) {
+        return false;
+    }
+    return defaultParse();
+}
+
+//===========================================================================
+template <typename A, typename T>
+bool Cli::OptShim<A, T>::deferrable() const {
+    return this->m_lazy && !this->m_flagValue && convertible();
+}
+
+//===========================================================================
+template <typename A, typename T>
+bool Cli::OptShim<A, T>::convertible() const {
+    return !this->m_bool
+        && m_checks.empty()
+        && defaultParse();
+}
+
+//===========================================================================
+template <typename A, typename T>
+bool Cli::OptShim<A, T>::convertValue(T & out, std::string_view value) const {
+    return convertValue(out, value, *this);
+}
+
+//===========================================================================
+template <typename A, typename T>
+bool Cli::OptShim<A, T>::convertValue(
+    T & out,
+    std::string_view value,
+    const Convert & cvt
+) const {
+    if (!m_choices.empty()) {
+        auto cd = this->findChoice(value);
+        if (!cd)
+            return false;
+        out = m_choices[cd->pos];
+        return true;
+    }
+    return cvt.fromString(out, value);
+}
+
+//===========================================================================
+template <typename A, typename T>
+template <typename U>
+auto Cli::OptShim<A, T>::moveString(U && out, std::string & src, int)
+    -> decltype(out = std::move(src), bool())
+{
+    out = std::move(src);
+    return true;
+}
+
+//===========================================================================
+template <typename A, typename T>
+template <typename U>
+bool Cli::OptShim<A, T>::moveString(U &&, std::string &, long) {
+    return false;
+}
+
 //===========================================================================
 template <typename A, typename T>
 inline bool Cli::OptShim<A, T>::inverted() const {
@@ -1782,6 +2946,9 @@ inline bool Cli::OptShim<Cli::Opt<bool>, bool>::inverted() const {
 template <typename A, typename T>
 A & Cli::OptShim<A, T>::command(const std::string & val) {
     m_command = fixCmdName(val);
+    if (auto list = this->m_listFileOpt)
+        list->m_command = m_command;
+    this->indexChanged();
     return static_cast<A &>(*this);
 }
 
@@ -1789,6 +2956,9 @@ A & Cli::OptShim<A, T>::command(const std::string & val) {
 template <typename A, typename T>
 A & Cli::OptShim<A, T>::allCmds(bool includeTopLevel) {
     m_command = allCmdsName(includeTopLevel);
+    if (auto list = this->m_listFileOpt)
+        list->m_command = m_command;
+    this->indexChanged();
     return static_cast<A &>(*this);
 }
 
@@ -1796,6 +2966,8 @@ A & Cli::OptShim<A, T>::allCmds(bool includeTopLevel) {
 template <typename A, typename T>
 A & Cli::OptShim<A, T>::group(const std::string & val) {
     m_group = val;
+    if (auto list = this->m_listFileOpt)
+        list->m_group = m_group;
     return static_cast<A &>(*this);
 }
 
@@ -1803,6 +2975,7 @@ A & Cli::OptShim<A, T>::group(const std::string & val) {
 template <typename A, typename T>
 A & Cli::OptShim<A, T>::show(bool visible) {
     m_visible = visible;
+    this->indexChanged();
     return static_cast<A &>(*this);
 }
 
@@ -1838,6 +3011,7 @@ A & Cli::OptShim<A, T>::defaultDesc(const std::string & val) {
 template <typename A, typename T>
 A & Cli::OptShim<A, T>::defaultValue(const T & val) {
     m_defValue = val;
+    static_cast<A *>(this)->m_proxy->m_dirty = true;
     for (auto && cd : m_choiceDescs)
         cd.second.def = !this->m_vector && val == m_choices[cd.second.pos];
     return static_cast<A &>(*this);
@@ -1860,6 +3034,8 @@ template <typename A, typename T>
 A & Cli::OptShim<A, T>::flagValue(bool isDefault) {
     auto self = static_cast<A *>(this);
     m_flagValue = true;
+    this->indexChanged();
+    self->m_proxy->m_dirty = true;
     if (!self->m_proxy->m_defFlagOpt) {
         // No previous default, mark this opt as the default.
         self->m_proxy->m_defFlagOpt = self;
@@ -1882,6 +3058,7 @@ A & Cli::OptShim<A, T>::flagValue(bool isDefault) {
 template <typename A, typename T>
 A & Cli::OptShim<A, T>::finalOpt() {
     this->m_finalOpt = true;
+    this->indexChanged();
     return static_cast<A &>(*this);
 }
 
@@ -1903,12 +3080,38 @@ A & Cli::OptShim<A, T>::choice(
     cd.sortKey = sortKey;
     cd.def = (!this->m_vector && val == this->defaultValue());
     m_choices.push_back(val);
+    this->m_choiceTable.reset();
+    return static_cast<A &>(*this);
+}
+
+//===========================================================================
+template <typename A, typename T>
+A & Cli::OptShim<A, T>::choiceFlags(int flags) {
+    this->m_choiceFlags = flags;
+    this->m_choiceTable.reset();
     return static_cast<A &>(*this);
 }
 
 //===========================================================================
 template <typename A, typename T>
 A & Cli::OptShim<A, T>::parse(std::function<ActionFn> fn) {
+    if (!fn) {
+        this->m_parse = {};
+    } else {
+        this->m_parse = [fn = std::move(fn)](
+            Cli & cli,
+            A & opt,
+            std::string_view val
+        ) {
+            fn(cli, opt, std::string(val));
+        };
+    }
+    return static_cast<A &>(*this);
+}
+
+//===========================================================================
+template <typename A, typename T>
+A & Cli::OptShim<A, T>::parseView(std::function<ViewActionFn> fn) {
     this->m_parse = std::move(fn);
     return static_cast<A &>(*this);
 }
@@ -1924,6 +3127,17 @@ A & Cli::OptShim<A, T>::check(std::function<ActionFn> fn) {
 template <typename A, typename T>
 A & Cli::OptShim<A, T>::after(std::function<ActionFn> fn) {
     this->m_afters.push_back(std::move(fn));
+    if (!this->m_hasAfters) {
+        this->m_hasAfters = true;
+        this->indexChanged();
+    }
+    return static_cast<A &>(*this);
+}
+
+//===========================================================================
+template <typename A, typename T>
+A & Cli::OptShim<A, T>::lazy(bool enable) {
+    this->m_lazy = enable;
     return static_cast<A &>(*this);
 }
 
@@ -1936,27 +3150,13 @@ A & Cli::OptShim<A, T>::require() {
 //===========================================================================
 template <typename A, typename T>
 A & Cli::OptShim<A, T>::siUnits(const std::string & symbol, int flags) {
-    auto units = siUnitMapping(symbol, flags);
-    return anyUnits(units.begin(), units.end(), flags);
+    return unitsAction(siUnitTable(symbol, flags), flags);
 }
 
 //===========================================================================
 template <typename A, typename T>
 A & Cli::OptShim<A, T>::timeUnits(int flags) {
-    return anyUnits({
-            {"y", 365 * 24 * 60 * 60},
-            {"w", 7 * 24 * 60 * 60},
-            {"d", 24 * 60 * 60},
-            {"h", 60 * 60},
-            {"m", 60},
-            {"min", 60},
-            {"s", 1},
-            {"ms", 1e-3},
-            {"us", 1e-6},
-            {"ns", 1e-9},
-        },
-        flags
-    );
+    return unitsAction(timeUnitTable(flags), flags);
 }
 
 //===========================================================================
@@ -1973,7 +3173,7 @@ template <typename A, typename T>
 template <typename U>
 auto Cli::OptShim<A, T>::checkLimits(
     Cli & cli,
-    const std::string & val,
+    std::string_view val,
     const U & x,
     int
 )
@@ -1988,7 +3188,7 @@ auto Cli::OptShim<A, T>::checkLimits(
     ) {
         return true;
     }
-    cli.badRange(*this, val, low, high);
+    cli.badRange(*this, std::string(val), low, high);
     return false;
 }
 
@@ -1997,58 +3197,155 @@ template <typename A, typename T>
 template <typename U>
 bool Cli::OptShim<A, T>::checkLimits(
     Cli &,
-    const std::string &,
+    std::string_view,
     const U &,
     long
 ) {
     return true;
 }
 
+//===========================================================================
+template <typename A, typename T>
+template <typename U>
+auto Cli::OptShim<A, T>::unitsValue(
+    Cli & cli,
+    std::string_view val,
+    std::string_view number,
+    std::string_view unit,
+    const UnitTable & units,
+    int flags,
+    int
+) -> typename std::enable_if<
+    std::is_arithmetic<U>::value && !std::is_same<U, bool>::value
+>::type {
+    if (!m_choices.empty())
+        return unitsValue(cli, val, number, unit, units, flags, 0L);
+
+    // Integers stay integers, unless the number is too big for int64_t or
+    // the multiplier of the units isn't an integer.
+    auto self = static_cast<A *>(this);
+    int64_t ival = 0;
+    long double dval = 0;
+    bool exact = false;
+    if (std::is_integral<U>::value) {
+        auto digits = number.substr(!number.empty() && number[0] == '-');
+        exact = !digits.empty()
+            && digits.find_first_not_of("0123456789") == digits.npos
+            && this->fromString(ival, number);
+    }
+    if (!exact && !this->fromString(dval, number)) {
+        cli.badUsage(*self, std::string(val));
+        return;
+    }
+    long double factor;
+    if (!this->unitsFactor(&factor, cli, val, unit, units, flags))
+        return;
+
+    if (exact
+        && factor >= 0
+        && factor < 0x1p62L
+        && factor == std::trunc(factor)
+    ) {
+        constexpr auto low = std::numeric_limits<U>::min();
+        constexpr auto high = std::numeric_limits<U>::max();
+        auto mult = (int64_t) factor;
+        bool valid = !mult
+            || (ival <= std::numeric_limits<int64_t>::max() / mult
+                && ival >= std::numeric_limits<int64_t>::min() / mult);
+        if (valid) {
+            ival *= mult;
+            if (ival < 0) {
+                valid = std::is_signed<U>::value && ival >= (int64_t) low;
+            } else {
+                valid = (uint64_t) ival <= (uint64_t) high;
+            }
+        }
+        if (!valid) {
+            cli.badRange(*self, std::string(val), low, high);
+            return;
+        }
+        assignValue(*self, (U) ival);
+        return;
+    }
+
+    if (exact)
+        dval = (long double) ival;
+    dval *= factor;
+    if (std::is_integral<U>::value)
+        dval = std::round(dval);
+    if (!checkLimits(cli, val, dval, 0))
+        return;
+    assignValue(*self, (U) dval);
+}
+
+//===========================================================================
+template <typename A, typename T>
+template <typename U>
+void Cli::OptShim<A, T>::unitsValue(
+    Cli & cli,
+    std::string_view val,
+    std::string_view number,
+    std::string_view unit,
+    const UnitTable & units,
+    int flags,
+    long
+) {
+    auto self = static_cast<A *>(this);
+    long double dval;
+    if (!this->fromString(dval, number)) {
+        cli.badUsage(*self, std::string(val));
+        return;
+    }
+    long double factor;
+    if (!this->unitsFactor(&factor, cli, val, unit, units, flags))
+        return;
+    dval *= factor;
+    if (!checkLimits(cli, val, dval, 0))
+        return;
+    std::string sval;
+    if (std::is_integral<T>::value)
+        dval = std::round(dval);
+    bool success = true;
+    auto ival = (int64_t) dval;
+    if (ival == dval) {
+        success = this->toString(sval, ival);
+        assert(success // LCOV_EXCL_LINE
+            && "Internal dimcli error: convert int64_t to string failed.");
+    } else {
+        success = this->toString(sval, dval);
+        assert(success // LCOV_EXCL_LINE
+            && "Internal dimcli error: convert double to string failed.");
+    }
+    if (!self->parseValue(sval))
+        cli.badUsage(*self, std::string(val));
+}
+
 //===========================================================================
 template <typename A, typename T>
 template <typename InputIt>
 A & Cli::OptShim<A, T>::anyUnits(InputIt first, InputIt last, int flags) {
+    std::vector<std::pair<std::string, long double>> units;
+    for (; first != last; ++first)
+        units.emplace_back(first->first, first->second);
+    return unitsAction(unitTable(units, flags), flags);
+}
+
+//===========================================================================
+template <typename A, typename T>
+A & Cli::OptShim<A, T>::unitsAction(
+    std::shared_ptr<const UnitTable> units,
+    int flags
+) {
     if (!m_valueDesc) {
         auto desc = defaultValueDesc()
             + ((flags & fUnitRequire) ? "<units>" : "[<units>]");
         m_valueDesc = std::make_unique<std::string>(desc);
     }
-    std::unordered_map<std::string, long double> units;
-    if (flags & fUnitInsensitive) {
-        auto & f = std::use_facet<std::ctype<char>>(std::locale());
-        std::string name;
-        for (; first != last; ++first) {
-            name = first->first;
-            f.tolower((char *) name.data(), name.data() + name.size());
-            units[name] = first->second;
-        }
-    } else {
-        units.insert(first, last);
-    }
-    return parse([units, flags](auto & cli, auto & opt, auto & val) {
-        long double dval;
-        bool success = true;
-        if (!opt.withUnits(dval, cli, val, units, flags))
-            return;
-        if (!opt.checkLimits(cli, val, dval, 0))
-            return;
-        std::string sval;
-        if (std::is_integral<T>::value)
-            dval = std::round(dval);
-        auto ival = (int64_t) dval;
-        if (ival == dval) {
-            success = opt.toString(sval, ival);
-            assert(success // LCOV_EXCL_LINE
-                && "Internal dimcli error: convert int64_t to string failed.");
-        } else {
-            success = opt.toString(sval, dval);
-            assert(success // LCOV_EXCL_LINE
-                && "Internal dimcli error: convert double to string failed.");
-        }
-        if (!opt.parseValue(sval)) {
-            success = false;
-            cli.badUsage(opt, val);
-        }
+    return parseView([units, flags](auto & cli, auto & opt, auto val) {
+        std::string_view number;
+        std::string_view unit;
+        if (opt.splitUnits(&number, &unit, cli, val))
+            opt.unitsValue(cli, val, number, unit, *units, flags, 0);
     });
 }
 
@@ -2079,6 +3376,37 @@ A & Cli::OptShim<A, T>::range(const T & low, const T & high) {
     });
 }
 
+//===========================================================================
+template <typename A, typename T>
+template <typename U>
+auto Cli::OptShim<A, T>::clamp(
+    const typename U::value_type & low,
+    const typename U::value_type & high
+) -> typename std::enable_if<rangeListType((U *) nullptr), A &>::type {
+    if (high < low)
+        assert(!"Bad clamp, low greater than high.");
+    return check([low, high](auto & /* cli */, auto & opt, auto & /* val */) {
+        lastValue(opt).clamp(low, high);
+    });
+}
+
+//===========================================================================
+template <typename A, typename T>
+template <typename U>
+auto Cli::OptShim<A, T>::range(
+    const typename U::value_type & low,
+    const typename U::value_type & high
+) -> typename std::enable_if<rangeListType((U *) nullptr), A &>::type {
+    if (high < low)
+        assert(!"Bad range, low greater than high.");
+    return check([low, high](auto & cli, auto & opt, auto & val) {
+        auto & ranges = lastValue(opt);
+        if (ranges.empty() || (ranges.front() >= low && ranges.back() <= high))
+            return;
+        cli.badRange(opt, val, low, high);
+    });
+}
+
 //===========================================================================
 template <typename A, typename T>
 A & Cli::OptShim<A, T>::prompt(int flags) {
@@ -2103,9 +3431,10 @@ A & Cli::OptShim<A, T>::prompt(const std::string & msg, int flags) {
 ***/
 
 struct Cli::ArgMatch {
-    // Name of the argument that populated the value, or an empty
-    // string if it wasn't populated.
-    std::string name;
+    // Name of the argument that populated the value, or null if it wasn't
+    // populated. Points to a name interned by the cli, so values don't each
+    // have their own copy.
+    const std::string * name = {};
 
     // Member of argv[] that populated the value or 0 if it wasn't.
     int pos = {};
@@ -2126,9 +3455,22 @@ struct Cli::Value {
     // Whether the value was explicitly set.
     bool m_explicit = {};
 
+    // Whether the value may have been changed since it was last reset.
+    bool m_dirty = true;
+
+    // Whether a non-const reference to the value has been handed out, after
+    // which it can be changed at any time.
+    bool m_exposed = false;
+
     // Points to the opt with the default flag value.
     Opt<T> * m_defFlagOpt = {};
 
+    // Argument, where it came from, and the opt to convert it with, when
+    // conversion has been deferred until the value is accessed.
+    Opt<T> * m_lazyOpt = {};
+    std::string m_lazyValue;
+    ArgMatch m_lazyMatch;
+
     T * m_value = {};
     T m_internal = {};
 
@@ -2150,11 +3492,17 @@ public:
     //-----------------------------------------------------------------------
     // QUERIES
 
-    T & operator*() { return *m_proxy->m_value; }
-    T * operator->() { return m_proxy->m_value; }
+    // Non-const access marks the value as always needing to be reset.
+    T & operator*() { m_proxy->m_exposed = true; return *access(); }
+    T * operator->() { m_proxy->m_exposed = true; return access(); }
+    const T & operator*() const { return *access(); }
+    const T * operator->() const { return access(); }
 
     // Inherited via OptBase
-    const std::string & from() const final { return m_proxy->m_match.name; }
+    const std::string & from() const final {
+        auto name = m_proxy->m_match.name;
+        return name ? *name : this->m_empty;
+    }
     int pos() const final { return m_proxy->m_match.pos; }
 
     //-----------------------------------------------------------------------
@@ -2162,12 +3510,38 @@ public:
 
     // Inherited via OptBase
     void reset() final;
-    bool parseValue(const std::string & value) final;
+    bool parseValue(std::string_view value) final;
 
 private:
     friend class Cli;
     bool defaultValueToString(std::string & out) const final;
-    bool match(const std::string & name, size_t pos) final;
+    bool dirty() const final {
+        // Values in external variables, or that references have been taken
+        // to, can be changed at any time, and values shared by options that
+        // aren't flags are reset to the default of the last one.
+        return m_proxy->m_dirty
+            || m_proxy->m_exposed
+            || m_proxy->m_value != &m_proxy->m_internal
+            || (m_proxy.use_count() > 1 && !this->m_flagValue);
+    }
+    bool moveValue(std::string & value) final {
+        if (!this->movable())
+            return false;
+        m_proxy->m_dirty = true;
+        m_proxy->m_lazyOpt = nullptr;
+        return this->moveString(*m_proxy->m_value, value, 0);
+    }
+    bool deferValue(std::string_view value) final;
+    bool convertDeferred(
+        ArgMatch * badMatch,
+        std::string * badValue
+    ) const final;
+    T * access() const {
+        if (m_proxy->m_lazyOpt)
+            this->convertOnAccess();
+        return m_proxy->m_value;
+    }
+    bool match(const std::string * name, size_t pos) final;
     bool matched() const final { return m_proxy->m_explicit; }
     void assignImplicit() final;
     bool sameValue(const void * value) const final {
@@ -2190,16 +3564,21 @@ Cli::Opt<T>::Opt(
 //===========================================================================
 template <typename T>
 inline void Cli::Opt<T>::reset() {
-    if (!this->m_flagValue || this->m_flagDefault)
+    m_proxy->m_lazyOpt = nullptr;
+    if (!this->m_flagValue || this->m_flagDefault) {
         *m_proxy->m_value = this->defaultValue();
-    m_proxy->m_match.name.clear();
+        m_proxy->m_dirty = false;
+    }
+    m_proxy->m_match.name = nullptr;
     m_proxy->m_match.pos = 0;
     m_proxy->m_explicit = false;
 }
 
 //===========================================================================
 template <typename T>
-inline bool Cli::Opt<T>::parseValue(const std::string & value) {
+inline bool Cli::Opt<T>::parseValue(std::string_view value) {
+    m_proxy->m_dirty = true;
+    m_proxy->m_lazyOpt = nullptr;
     auto & tmp = *m_proxy->m_value;
     if (this->m_flagValue) {
         // Value passed for flagValue (just like bools) is generated
@@ -2212,14 +3591,40 @@ inline bool Cli::Opt<T>::parseValue(const std::string & value) {
         }
         return true;
     }
-    if (!this->m_choices.empty()) {
-        auto i = this->m_choiceDescs.find(value);
-        if (i == this->m_choiceDescs.end())
-            return false;
-        tmp = this->m_choices[i->second.pos];
+    return this->convertValue(tmp, value);
+}
+
+//===========================================================================
+template <typename T>
+inline bool Cli::Opt<T>::deferValue(std::string_view value) {
+    if (!this->deferrable() || m_proxy->m_value != &m_proxy->m_internal)
+        return false;
+    // Only the last argument is kept, but earlier ones must still be valid,
+    // as they are when converted one at a time. Errors abort the parse.
+    if (m_proxy->m_lazyOpt && !this->convertOnAccess())
         return true;
-    }
-    return this->fromString(tmp, value);
+    m_proxy->m_lazyOpt = this;
+    m_proxy->m_lazyValue = value;
+    m_proxy->m_lazyMatch = m_proxy->m_match;
+    return true;
+}
+
+//===========================================================================
+template <typename T>
+inline bool Cli::Opt<T>::convertDeferred(
+    ArgMatch * badMatch,
+    std::string * badValue
+) const {
+    auto opt = m_proxy->m_lazyOpt;
+    if (!opt)
+        return true;
+    m_proxy->m_lazyOpt = nullptr;
+    if (opt->convertValue(*m_proxy->m_value, m_proxy->m_lazyValue))
+        return true;
+    *m_proxy->m_value = T{};
+    *badMatch = m_proxy->m_lazyMatch;
+    *badValue = m_proxy->m_lazyValue;
+    return false;
 }
 
 //===========================================================================
@@ -2230,7 +3635,8 @@ inline bool Cli::Opt<T>::defaultValueToString(std::string & out) const {
 
 //===========================================================================
 template <typename T>
-inline bool Cli::Opt<T>::match(const std::string & name, size_t pos) {
+inline bool Cli::Opt<T>::match(const std::string * name, size_t pos) {
+    m_proxy->m_dirty = true;
     m_proxy->m_match.name = name;
     m_proxy->m_match.pos = (int)pos;
     m_proxy->m_explicit = true;
@@ -2240,6 +3646,7 @@ inline bool Cli::Opt<T>::match(const std::string & name, size_t pos) {
 //===========================================================================
 template <typename T>
 inline void Cli::Opt<T>::assignImplicit() {
+    m_proxy->m_lazyOpt = nullptr;
     *m_proxy->m_value = this->implicitValue();
 }
 
@@ -2252,12 +3659,52 @@ inline void Cli::Opt<T>::assignImplicit() {
 
 template <typename T>
 struct Cli::ValueVec {
-    // Where the values came from.
-    std::vector<ArgMatch> m_matches;
+    // Where the values came from, as runs of values from consecutive
+    // arguments with the same name. So a long list of operands is recorded
+    // as a single run instead of a match for each value. Many values from
+    // the same argument, such as the entries of a list file, are also a
+    // single run.
+    struct MatchRun {
+        size_t index; // of the first value of the run
+        const std::string * name;
+        int pos; // of the first value
+        int step; // between args of values, 0 if all from the same arg
+    };
+    std::vector<MatchRun> m_matches;
+    size_t m_numMatches = 0;
+
+    void addMatch(const std::string * name, int pos);
+    void popMatch();
+    void clearMatches();
+    // Where the value at the index, which must be less than m_numMatches,
+    // came from.
+    ArgMatch findMatch(size_t index) const;
 
     // Points to the opt with the default flag value.
     OptVec<T> * m_defFlagOpt = {};
 
+    // Whether the values may have been changed since they were last reset.
+    bool m_dirty = true;
+
+    // Arguments, and the opts to convert them with, for values whose
+    // conversion has been deferred until they're accessed.
+    struct Deferred {
+        size_t index;
+        OptVec<T> * opt;
+        std::string value;
+    };
+    std::vector<Deferred> m_deferred;
+
+    // Arguments, and the opts to convert them with, whose conversion was
+    // left until the end of the parse so it can be split between threads.
+    // The arguments outlive the parse, so they aren't copied.
+    struct Pending {
+        size_t index;
+        OptVec<T> * opt;
+        std::string_view value;
+    };
+    std::vector<Pending> m_pending;
+
     std::vector<T> * m_values = {};
     std::vector<T> m_internal;
 
@@ -2266,6 +3713,60 @@ struct Cli::ValueVec {
     {}
 };
 
+//===========================================================================
+template <typename T>
+void Cli::ValueVec<T>::addMatch(const std::string * name, int pos) {
+    if (!m_matches.empty()) {
+        auto & run = m_matches.back();
+        auto count = m_numMatches - run.index;
+        if (run.name == name) {
+            if (count == 1 && pos == run.pos)
+                run.step = 0;
+            if ((size_t) pos == run.pos + run.step * count) {
+                m_numMatches += 1;
+                return;
+            }
+        }
+    }
+    m_matches.push_back({m_numMatches, name, pos, 1});
+    m_numMatches += 1;
+}
+
+//===========================================================================
+template <typename T>
+void Cli::ValueVec<T>::popMatch() {
+    m_numMatches -= 1;
+    auto & run = m_matches.back();
+    if (run.index == m_numMatches) {
+        m_matches.pop_back();
+    } else if (run.index + 1 == m_numMatches) {
+        run.step = 1;
+    }
+}
+
+//===========================================================================
+template <typename T>
+void Cli::ValueVec<T>::clearMatches() {
+    m_matches.clear();
+    m_numMatches = 0;
+}
+
+//===========================================================================
+template <typename T>
+Cli::ArgMatch Cli::ValueVec<T>::findMatch(size_t index) const {
+    auto i = std::upper_bound(
+        m_matches.begin(),
+        m_matches.end(),
+        index,
+        [](size_t a, auto & b) { return a < b.index; }
+    );
+    auto & run = *std::prev(i);
+    ArgMatch out;
+    out.name = run.name;
+    out.pos = run.pos + run.step * int(index - run.index);
+    return out;
+}
+
 
 /****************************************************************************
 *
@@ -2286,13 +3787,41 @@ public:
     OptVec & size(int exact);
     OptVec & size(int min, int max);
 
+    // Passes each value to the function as soon as it's been parsed and
+    // checked, instead of keeping it. So memory stays flat no matter how many
+    // values there are. The values still count toward the size limits, and
+    // opt.size(), opt.from(index), and opt.pos(index) still describe all of
+    // them, but the vector itself stays empty. The function can report a
+    // bad value with cli.badUsage(), which stops the parse.
+    using SinkFn = void(Cli & cli, OptVec & opt, T && value);
+    OptVec & sink(std::function<SinkFn> fn);
+
+    // Converts the values at the end of the parse, on multiple threads when
+    // there are many of them, instead of one at a time as they're reached.
+    // Only applies when the default parse action is used and there are no
+    // check actions. The values, and the error reported if any are invalid,
+    // are the same as when they're converted one at a time.
+    OptVec & parallel(bool enable = true);
+
+    // Adds an option, to the same command and group (and following this one
+    // if it's later moved), that takes the name of a list file, or "-" for
+    // stdin, and adds each of its entries as a value of this one. Entries are
+    // separated by NUL characters if there are any in the file, otherwise by
+    // newlines, and empty entries are skipped. The file is mapped into memory
+    // and the entries parsed straight from it, without the quoting rules of
+    // response files.
+    //
+    // Values from the list are matched to the list option's name and
+    // argument position, and are never left pending by parallel().
+    OptVec & fromListFile(const std::string & names);
+
     //-----------------------------------------------------------------------
     // QUERIES
 
-    std::vector<T> & operator*() { return *m_proxy->m_values; }
-    std::vector<T> * operator->() { return m_proxy->m_values; }
+    std::vector<T> & operator*() { return *access(); }
+    std::vector<T> * operator->() { return access(); }
 
-    T & operator[](size_t index) { return (*m_proxy->m_values)[index]; }
+    T & operator[](size_t index) { return (*access())[index]; }
     const T & operator[](size_t index) const {
         return const_cast<T *>(this)[index];
     }
@@ -2308,7 +3837,9 @@ public:
     // Inherited via OptBase
     const std::string & from() const final { return from(size() - 1); }
     int pos() const final { return pos(size() - 1); }
-    size_t size() const final { return m_proxy->m_values->size(); }
+    size_t size() const final {
+        return m_sink ? m_proxy->m_numMatches : m_proxy->m_values->size();
+    }
     int minSize() const final { return m_minVec; }
     int maxSize() const final { return m_maxVec; }
 
@@ -2317,24 +3848,62 @@ public:
 
     // Inherited via OptBase
     void reset() final;
-    bool parseValue(const std::string & value) final;
+    bool parseValue(std::string_view value) final;
 
 private:
     friend class Cli;
     bool defaultValueToString(std::string & out) const final;
-    bool match(const std::string & name, size_t pos) final;
-    bool matched() const final { return !m_proxy->m_values->empty(); }
+    bool dirty() const final {
+        return m_proxy->m_dirty
+            || !m_proxy->m_values->empty()
+            || !m_proxy->m_matches.empty();
+    }
+    bool moveValue(std::string & value) final {
+        if (!this->movable())
+            return false;
+        return this->moveString(m_proxy->m_values->back(), value, 0);
+    }
+    bool deferValue(std::string_view value) final;
+    bool convertDeferred(
+        ArgMatch * badMatch,
+        std::string * badValue
+    ) const final;
+    void reserveValues(size_t count) final {
+        if (m_sink)
+            return;
+        auto & values = *m_proxy->m_values;
+        values.reserve(values.size() + count);
+        if (m_parallel) {
+            auto & pending = m_proxy->m_pending;
+            pending.reserve(pending.size() + count);
+        }
+    }
+    void sinkValue(Cli & cli) final;
+    bool convertPending(
+        ArgMatch * badMatch,
+        std::string * badValue,
+        size_t limit
+    ) final;
+    std::vector<T> * access() const {
+        if (!m_proxy->m_deferred.empty())
+            this->convertOnAccess();
+        return m_proxy->m_values;
+    }
+    bool match(const std::string * name, size_t pos) final;
+    bool matched() const final { return size() != 0; }
     void assignImplicit() final;
     bool sameValue(const void * value) const final {
         return value == m_proxy->m_values;
     }
 
     std::shared_ptr<ValueVec<T>> m_proxy;
-    std::string m_empty;
 
     // Minimum and maximum number of values allowed in vector.
     int m_minVec = 1;
     int m_maxVec = 1;
+
+    std::function<SinkFn> m_sink;
+    bool m_parallel = false;
 };
 
 //===========================================================================
@@ -2358,6 +3927,7 @@ inline Cli::OptVec<T> & Cli::OptVec<T>::size(int exact) {
         assert(!"Bad optVec size, minimum must be >= 0.");
     } else {
         this->m_minVec = this->m_maxVec = exact;
+        this->indexChanged();
     }
     return *this;
 }
@@ -2374,13 +3944,37 @@ inline Cli::OptVec<T> & Cli::OptVec<T>::size(int min, int max) {
     } else {
         this->m_minVec = min;
         this->m_maxVec = max;
+        this->indexChanged();
     }
     return *this;
 }
 
 //===========================================================================
 template <typename T>
-inline bool Cli::OptVec<T>::parseValue(const std::string & value) {
+inline Cli::OptVec<T> & Cli::OptVec<T>::sink(std::function<SinkFn> fn) {
+    m_sink = std::move(fn);
+    return *this;
+}
+
+//===========================================================================
+template <typename T>
+inline Cli::OptVec<T> & Cli::OptVec<T>::parallel(bool enable) {
+    m_parallel = enable;
+    return *this;
+}
+
+//===========================================================================
+template <typename T>
+inline Cli::OptVec<T> & Cli::OptVec<T>::fromListFile(
+    const std::string & names
+) {
+    this->addListFileOpt(names);
+    return *this;
+}
+
+//===========================================================================
+template <typename T>
+inline bool Cli::OptVec<T>::parseValue(std::string_view value) {
     auto back = std::prev(m_proxy->m_values->end());
     if (this->m_flagValue) {
         // Value passed for flagValue (just like bools) is generated
@@ -2391,26 +3985,108 @@ inline bool Cli::OptVec<T>::parseValue(const std::string & value) {
             assert(value == "0" // LCOV_EXCL_LINE
                 && "Internal dimcli error: flagValue not parsed from 0 or 1.");
             m_proxy->m_values->pop_back();
-            m_proxy->m_matches.pop_back();
+            m_proxy->popMatch();
         }
         return true;
     }
-    if (!this->m_choices.empty()) {
-        auto i = this->m_choiceDescs.find(value);
-        if (i == this->m_choiceDescs.end())
-            return false;
-        *back = this->m_choices[i->second.pos];
-        return true;
-    }
 
     // Parsed indirectly through temporary for cases like vector<bool> where
     // *back returns a proxy object instead of a reference to T.
     T tmp{};
-    bool result = this->fromString(tmp, value);
+    bool result = this->convertValue(tmp, value);
     *back = std::move(tmp);
     return result;
 }
 
+//===========================================================================
+template <typename T>
+inline bool Cli::OptVec<T>::deferValue(std::string_view value) {
+    if (m_parallel
+        && !m_sink
+        && this->convertible()
+        && this->pendingAllowed()
+    ) {
+        // Build the choice table now, so converting threads only read it.
+        this->choiceTable();
+        auto index = m_proxy->m_values->size() - 1;
+        m_proxy->m_pending.push_back({index, this, value});
+        return true;
+    }
+    if (!this->deferrable()
+        || m_sink
+        || m_proxy->m_values != &m_proxy->m_internal
+    ) {
+        return false;
+    }
+    auto index = m_proxy->m_values->size() - 1;
+    m_proxy->m_deferred.push_back({index, this, std::string(value)});
+    return true;
+}
+
+//===========================================================================
+template <typename T>
+inline bool Cli::OptVec<T>::convertDeferred(
+    ArgMatch * badMatch,
+    std::string * badValue
+) const {
+    auto & values = *m_proxy->m_values;
+    bool success = true;
+    for (auto && def : m_proxy->m_deferred) {
+        T tmp{};
+        if (!def.opt->convertValue(tmp, def.value) && success) {
+            success = false;
+            *badMatch = m_proxy->findMatch(def.index);
+            *badValue = def.value;
+        }
+        values[def.index] = std::move(tmp);
+    }
+    m_proxy->m_deferred.clear();
+    return success;
+}
+
+//===========================================================================
+template <typename T>
+inline bool Cli::OptVec<T>::convertPending(
+    ArgMatch * badMatch,
+    std::string * badValue,
+    size_t limit
+) {
+    auto & pending = m_proxy->m_pending;
+    if (pending.empty())
+        return true;
+    // Values of arguments at or after the limit weren't reached when parsing
+    // one at a time.
+    auto num = pending.size();
+    while (num
+        && (size_t) m_proxy->findMatch(pending[num - 1].index).pos >= limit
+    ) {
+        num -= 1;
+    }
+    auto & values = *m_proxy->m_values;
+    auto bad = convertChunks(
+        num,
+        this->maxThreads(),
+        this->m_locale,
+        [&](const Convert & cvt, size_t first, size_t last) {
+            for (auto i = first; i < last; ++i) {
+                auto & pend = pending[i];
+                T tmp{};
+                if (!pend.opt->convertValue(tmp, pend.value, cvt))
+                    return i;
+                values[pend.index] = std::move(tmp);
+            }
+            return last;
+        }
+    );
+    bool success = bad == num;
+    if (!success) {
+        *badMatch = m_proxy->findMatch(pending[bad].index);
+        *badValue = pending[bad].value;
+    }
+    pending.clear();
+    return success;
+}
+
 //===========================================================================
 template <typename T>
 inline bool Cli::OptVec<T>::defaultValueToString(std::string & out) const {
@@ -2421,27 +4097,38 @@ inline bool Cli::OptVec<T>::defaultValueToString(std::string & out) const {
 //===========================================================================
 template <typename T>
 inline void Cli::OptVec<T>::reset() {
+    m_proxy->m_deferred.clear();
+    m_proxy->m_pending.clear();
     m_proxy->m_values->clear();
-    m_proxy->m_matches.clear();
+    m_proxy->clearMatches();
+    m_proxy->m_dirty = false;
 }
 
 //===========================================================================
 template <typename T>
-inline bool Cli::OptVec<T>::match(const std::string & name, size_t pos) {
+inline bool Cli::OptVec<T>::match(const std::string * name, size_t pos) {
     if (this->m_maxVec != -1
-        && (size_t) this->m_maxVec == m_proxy->m_matches.size()
+        && (size_t) this->m_maxVec == m_proxy->m_numMatches
     ) {
         return false;
     }
 
-    ArgMatch match;
-    match.name = name;
-    match.pos = (int)pos;
-    m_proxy->m_matches.push_back(match);
-    m_proxy->m_values->resize(m_proxy->m_matches.size());
+    m_proxy->addMatch(name, (int) pos);
+    m_proxy->m_values->resize(m_proxy->m_values->size() + 1);
     return true;
 }
 
+//===========================================================================
+template <typename T>
+inline void Cli::OptVec<T>::sinkValue(Cli & cli) {
+    auto & values = *m_proxy->m_values;
+    if (!m_sink || values.empty())
+        return;
+    T tmp = std::move(values.back());
+    values.pop_back();
+    m_sink(cli, *this, std::move(tmp));
+}
+
 //===========================================================================
 template <typename T>
 inline void Cli::OptVec<T>::assignImplicit() {
@@ -2452,16 +4139,16 @@ inline void Cli::OptVec<T>::assignImplicit() {
 template <typename T>
 inline const std::string & Cli::OptVec<T>::from(size_t index) const {
     if (index >= size()) {
-        return m_empty;
+        return this->m_empty;
     } else {
-        return m_proxy->m_matches[index].name;
+        return *m_proxy->findMatch(index).name;
     }
 }
 
 //===========================================================================
 template <typename T>
 inline int Cli::OptVec<T>::pos(size_t index) const {
-    return index >= size() ? 0 : m_proxy->m_matches[index].pos;
+    return index >= size() ? 0 : m_proxy->findMatch(index).pos;
 }
 
 } // namespace
@@ -2496,5 +4183,6 @@ inline int Cli::OptVec<T>::pos(size_t index) const {
 
 #undef DIMCLI_LIB_FILESYSTEM
 #undef DIMCLI_LIB_FILESYSTEM_PATH
+#undef DIMCLI_LIB_CHARCONV
 
 #endif
@@ -488,6 +488,45 @@ ostream & operator<<(ostream & os, const ExtractWithInsert & in) {
     return os;
 }
 
+struct Span {
+    int first = 0;
+    int last = 0;
+};
+
+//===========================================================================
+template<>
+bool Dim::Cli::Convert::fromString<Span>(
+    Span & out,
+    string_view src
+) const {
+    auto pos = src.find('-');
+    return pos != string_view::npos
+        && fromString(out.first, src.substr(0, pos))
+        && fromString(out.last, src.substr(pos + 1));
+}
+
+struct Counted {
+    static inline int s_conversions = 0;
+    int value = 0;
+
+    bool operator==(const Counted & other) const {
+        return value == other.value;
+    }
+};
+istream & operator>>(istream & is, Counted & out) {
+    Counted::s_conversions += 1;
+    return is >> out.value;
+}
+
+struct Thrower {
+    int value = 0;
+};
+istream & operator>>(istream & is, Thrower & out) {
+    if (is >> out.value && out.value > 99999)
+        throw runtime_error("too big");
+    return is;
+}
+
 //===========================================================================
 void valueTests() {
     int line = 0;
@@ -510,6 +549,158 @@ void valueTests() {
         EXPECT(*sum == 6);
     }
 
+    // values moved from owned arguments
+    {
+        cli = {};
+        auto & str = cli.opt<string>("s");
+        auto & chk = cli.opt<string>("c")
+            .check([](auto &, auto &, auto &) {});
+        auto & files = cli.optVec<string>("[file]");
+        auto args = vector<string>{
+            "test", "-s", "moved", "-cchecked", "-c", "copied", "a.txt", "b"
+        };
+        EXPECT(cli.parse(move(args)));
+        EXPECT(*str == "moved");
+        EXPECT(*chk == "copied");
+        EXPECT(files.size() == 2 && files[0] == "a.txt" && files[1] == "b");
+        EXPECT(args[2].empty() && args[6].empty() && args[7].empty());
+        EXPECT(args[3] == "-cchecked" && args[5] == "copied");
+
+        args = {"test", "-s", "kept", "x"};
+        EXPECT(cli.parse(args));
+        EXPECT(*str == "kept" && args[2] == "kept");
+    }
+
+    // lazy conversion
+    {
+        cli = {};
+        auto & cnt = cli.opt<Counted>("c").lazy();
+        Counted::s_conversions = 0;
+        EXPECT_PARSE(cli, "-c1 -c2");
+        EXPECT(Counted::s_conversions == 1);
+        EXPECT_PARSE(cli, "-c3");
+        EXPECT(Counted::s_conversions == 1);
+        EXPECT(cnt && cnt.from() == "-c");
+        EXPECT(cnt->value == 3);
+        EXPECT(cnt->value == 3);
+        EXPECT(Counted::s_conversions == 2);
+
+        auto & num = cli.opt<int>("n").lazy();
+        EXPECT_PARSE(cli, "-n x");
+        EXPECT(!cli.validate());
+        EXPECT_ERR(cli, "Error: Invalid '-n' value: x\n");
+        EXPECT(cli.validate());
+        EXPECT_PARSE(cli, "-n y");
+        EXPECT(*num == 0);
+        EXPECT_ERR(cli, "Error: Invalid '-n' value: y\n");
+        EXPECT_PARSE(cli, "-n 7");
+        EXPECT(cli.validate() && *num == 7);
+
+        // Replaced arguments must still be valid.
+        auto & m = cli.opt<int>("m mm").lazy();
+        EXPECT_PARSE(cli, "--mm x -m 3", false);
+        EXPECT_ERR(cli, "Error: Invalid '--mm' value: x\n");
+        EXPECT_PARSE(cli, "-n x -n 3", false);
+        EXPECT_ERR(cli, "Error: Invalid '-n' value: x\n");
+        EXPECT_PARSE(cli, "--mm 2 -m 3");
+        EXPECT(*m == 3 && m.from() == "-m");
+
+        cli = {};
+        cli.lazyValues();
+        auto & a = cli.opt<int>("a");
+        auto & b = cli.opt<int>("b");
+        auto & vals = cli.optVec<int>("[value]");
+        auto & chk = cli.opt<int>("c").check([](auto &, auto &, auto &) {});
+        EXPECT_PARSE(cli, "-cx", false);
+        EXPECT_PARSE(cli, "-b1 -a2 1 x 3 y");
+        EXPECT(vals.size() == 4);
+        EXPECT(!cli.validate());
+        EXPECT_ERR(cli, "Error: Invalid 'value' value: x\n");
+        EXPECT(*a == 2 && *b == 1 && *chk == 0);
+        EXPECT(vals[0] == 1 && vals[1] == 0 && vals[2] == 3 && vals[3] == 0);
+        EXPECT_PARSE(cli, "-bx -ay");
+        EXPECT(!cli.validate());
+        EXPECT_ERR(cli, "Error: Invalid '-b' value: x\n");
+    }
+
+    // string_view parse action
+    {
+        cli = {};
+        string_view seen;
+        auto & opt = cli.opt<string>("s")
+            .parseView([&](auto &, auto & opt, string_view val) {
+                seen = val;
+                *opt = string(val) + "!";
+            });
+        vector<string> args = {"test", "-s", "abc"};
+        EXPECT(cli.parse(args));
+        EXPECT(*opt == "abc!");
+        EXPECT(seen.data() == args[2].data());
+
+        // Generic parse actions still get a std::string.
+        auto & up = cli.opt<string>("u")
+            .parse([](auto &, auto & opt, auto & val) {
+                *opt = val.substr(0, val.size() - 1) + val.c_str()[0];
+            });
+        EXPECT_PARSE(cli, "-u abc");
+        EXPECT(*up == "aba");
+
+        auto & spans = cli.optVec<Span>("[span]");
+        EXPECT_PARSE(cli, "1-2 30-40");
+        EXPECT(spans.size() == 2 && spans[1].first == 30
+            && spans[1].last == 40);
+        EXPECT_PARSE(cli, "1-", false);
+        EXPECT_ERR(cli, "Error: Invalid 'span' value: 1-\n");
+    }
+
+    // numbers
+    {
+        cli = {};
+        auto & opt = cli.opt<int>("n");
+        int i = 0;
+        EXPECT(opt.fromString(i, "42") && i == 42);
+        EXPECT(opt.fromString(i, "-7") && i == -7);
+        EXPECT(opt.fromString(i, "+5") && i == 5);
+        EXPECT(opt.fromString(i, " 6 ") && i == 6);
+        EXPECT(!opt.fromString(i, "5x") && i == 0);
+        EXPECT(!opt.fromString(i, "99999999999"));
+        EXPECT(!opt.fromString(i, "1.5"));
+        unsigned u = 0;
+        EXPECT(opt.fromString(u, "4000000000") && u == 4'000'000'000);
+        double d = 0;
+        EXPECT(opt.fromString(d, "1.5") && d == 1.5);
+        EXPECT(opt.fromString(d, "-.25") && d == -0.25);
+        EXPECT(opt.fromString(d, "1e3") && d == 1000);
+        EXPECT(!opt.fromString(d, "inf"));
+        EXPECT(!opt.fromString(d, "nan"));
+        EXPECT(!opt.fromString(d, "1.5.1"));
+        char c = 0;
+        EXPECT(opt.fromString(c, "7") && c == '7');
+        EXPECT(!opt.fromString(c, "77"));
+
+        string str;
+        EXPECT(opt.toString(str, -42) && str == "-42");
+        EXPECT(opt.toString(str, 18'446'744'073'709'551'615u)
+            && str == "18446744073709551615");
+        EXPECT(opt.toString(str, 0.1) && str == "0.1");
+        EXPECT(opt.toString(str, 1234567.0) && str == "1234567");
+        EXPECT(opt.toString(str, 1.0 / 3) && str == "0.3333333333333333");
+        EXPECT(opt.fromString(d, str) && d == 1.0 / 3);
+        EXPECT(opt.toString(str, 2.5f) && str == "2.5");
+        EXPECT(opt.toString(str, 'x') && str == "x");
+
+        cli = {};
+        cli.opt<double>("d", 1.0 / 8).desc("Ratio.");
+        EXPECT_HELP(cli, "", 1 + R"(
+Usage: test [OPTIONS]
+
+Options:
+  -d FLOAT  Ratio. (default: 0.125)
+
+  --help    Show this message and exit.
+)");
+    }
+
     // parsing failure
     {
         cli = {};
@@ -575,6 +766,64 @@ Options:
   --complex=VALUE  Complex number to parse. (default: (0,0))
 
   --help           Show this message and exit.
+)");
+    }
+
+    // range list
+    {
+        cli = {};
+        using Ranges = Dim::Cli::RangeList<int>;
+        auto & shards = cli.opt<Ranges>("shards", {{0, 9}, {20, 29}})
+            .desc("Shards to process.");
+        EXPECT_PARSE(cli);
+        EXPECT(shards->size() == 20 && shards->contains(25));
+        EXPECT(!shards->contains(10) && !shards->contains(-1));
+        EXPECT_PARSE(cli, "--shards=0-99999,150000-199999,7");
+        EXPECT(shards->size() == 150'000 && shards->ranges().size() == 2);
+        EXPECT(shards->contains(150'000) && !shards->contains(100'000));
+        EXPECT_PARSE(cli, "--shards=8,-3--1,5-6,7,2147483647");
+        auto imax = numeric_limits<int>::max();
+        EXPECT(*shards == Ranges({{-3, -1}, {5, 8}, {imax, imax}}));
+        vector<int> vals(shards->begin(), shards->end());
+        EXPECT(vals == vector<int>({-3, -2, -1, 5, 6, 7, 8, imax}));
+        string out;
+        EXPECT(shards.toString(out, *shards) && out == "-3--1,5-8,2147483647");
+        EXPECT_PARSE(cli, "--shards=5-3", false);
+        EXPECT_ERR(cli, "Error: Invalid '--shards' value: 5-3\n");
+        EXPECT_PARSE(cli, "--shards=1,,2", false);
+        EXPECT_ERR(cli, "Error: Invalid '--shards' value: 1,,2\n");
+        EXPECT_HELP(cli, "", 1 + R"(
+Usage: test [OPTIONS]
+
+Options:
+  --shards=RANGES  Shards to process. (default: 0-9,20-29)
+
+  --help           Show this message and exit.
+)");
+
+        shards.clamp(0, 99);
+        auto & parts = cli.opt<Dim::Cli::RangeList<uint64_t>>("parts")
+            .range(1, 8);
+        EXPECT_PARSE(cli, "--shards=-5-5,90-200 --parts=1-3,8");
+        EXPECT(*shards == Ranges({{0, 5}, {90, 99}}) && parts->size() == 4);
+        EXPECT_PARSE(cli, "--parts=0-3", false);
+        EXPECT_ERR(cli, 1 + R"(
+Error: Out of range '--parts' value: 0-3
+Must be between '1' and '8'.
+)");
+        auto & ids = cli.opt<Dim::Cli::RangeList<uint64_t>>("ids");
+        EXPECT_PARSE(cli, "--ids=0-18446744073709551615");
+        EXPECT(ids->size() == numeric_limits<uintmax_t>::max());
+
+        auto & sets = cli.optVec<Ranges>("set").clamp(0, 9);
+        auto & runs = cli.optVec<Ranges>("run").range(1, 4);
+        EXPECT_PARSE(cli, "--set=-1-3 --set=5,20 --run=1-2 --run=4");
+        EXPECT(sets.size() == 2 && sets[1] == Ranges({{5, 5}}));
+        EXPECT(sets[0] == Ranges({{0, 3}}) && runs[1].size() == 1);
+        EXPECT_PARSE(cli, "--run=1 --run=5", false);
+        EXPECT_ERR(cli, 1 + R"(
+Error: Out of range '--run' value: 5
+Must be between '1' and '4'.
 )");
     }
 }
@@ -588,6 +837,7 @@ Options:
 
 //===========================================================================
 void parseTests() {
+    int line = 0;
     CliTest cli;
 
     cli = {};
@@ -641,6 +891,70 @@ void parseTests() {
     cli.opt("<n>", 1);
     EXPECT_PARSE(cli, "", false);
     EXPECT_ERR(cli, "Error: Option 'n' missing value.\n");
+
+    // Options added or changed after a parse are seen by the next one.
+    cli = {};
+    auto & a1 = cli.opt<int>("a");
+    EXPECT_PARSE(cli, "-a1");
+    EXPECT(*a1 == 1);
+    EXPECT_PARSE(cli, "-b2", false);
+    EXPECT_ERR(cli, "Error: Unknown option: -b\n");
+    auto & b1 = cli.opt<int>("b");
+    EXPECT_PARSE(cli, "-b2");
+    EXPECT(*b1 == 2);
+    b1.command("x");
+    EXPECT_PARSE(cli, "-b2", false);
+    EXPECT_ERR(cli, "Error: Unknown option: -b\n");
+    EXPECT_PARSE(cli, "x -b3");
+    EXPECT(*b1 == 3);
+
+    // Parse argv in place, and when it's copied to be modified.
+    {
+        cli = {};
+        auto & a = cli.opt<int>("a");
+        auto & b = cli.optVec<string>("[B]");
+        const char * argv[] = { "test", "-a3", "x", "-a", "4", "y", NULL };
+        auto argc = sizeof argv / sizeof *argv - 1;
+        EXPECT(cli.parse(argc, (char **) argv));
+        EXPECT(*a == 4 && b.size() == 2 && b[1] == "y");
+        EXPECT(b.from(0) == "B" && b.pos(1) == 5);
+        EXPECT(&b.from(0) == &b.from(1));
+        cli.before([](auto &, auto & args) { args.pop_back(); });
+        EXPECT(cli.parse(argc, (char **) argv));
+        EXPECT(*a == 4 && b.size() == 1 && b[0] == "x");
+    }
+
+    // Only options that may have changed are reset.
+    {
+        cli = {};
+        int ext = 0;
+        auto & a = cli.opt<int>("a", 1);
+        auto & b = cli.opt<string>("b", "x");
+        cli.opt(&ext, "c", 3);
+        auto & d = cli.optVec<int>("d");
+        EXPECT_PARSE(cli, "-a2 -d1");
+        EXPECT(cli.resetsSkipped() == 0);
+        EXPECT(*a == 2 && ext == 3);
+        ext = 4;
+        EXPECT_PARSE(cli, "");
+        EXPECT(cli.resetsSkipped() == 2);  // b and --help
+        EXPECT(*a == 1 && ext == 3 && !d);
+        *b = "y";
+        EXPECT_PARSE(cli, "");
+        EXPECT(cli.resetsSkipped() == 2);  // d and --help
+        EXPECT(*b == "x");
+        b.defaultValue("z");
+        EXPECT_PARSE(cli, "");
+        EXPECT(*b == "z");
+
+        // Writes through a reference held from before the last reset.
+        auto & e = cli.opt<int>("e", 1);
+        int & n = *e;
+        EXPECT_PARSE(cli, "");
+        n = 5;
+        EXPECT_PARSE(cli, "");
+        EXPECT(n == 1);
+    }
 }
 
 
@@ -650,6 +964,18 @@ void parseTests() {
 *
 ***/
 
+// Folds 'I' to '1', so folding by it can be told apart from the "C" locale.
+struct OddFolding : ctype<char> {
+    char do_tolower(char ch) const override {
+        return ch == 'I' ? '1' : ctype::do_tolower(ch);
+    }
+    const char * do_tolower(char * low, const char * high) const override {
+        for (; low != high; ++low)
+            *low = do_tolower(*low);
+        return high;
+    }
+};
+
 //===========================================================================
 void choiceTests() {
     int line = 0;
@@ -749,6 +1075,68 @@ Error: Invalid '-n' value: white
 Must be 'one', 'two', 'three', 'four', 'five', 'six', 'seven', 'eight', 'nine',
 'ten', 'eleven', or 'twelve'.
 )");
+
+    for (unsigned i = 13; i <= 30; ++i)
+        nums.choice(i, "n" + to_string(i));
+    EXPECT_PARSE(cli, "-n white", false);
+    EXPECT_ERR(cli, 1 + R"(
+Error: Invalid '-n' value: white
+Must be 'one', 'two', 'three', 'four', 'five', 'six', 'seven', 'eight', 'nine',
+'ten', 'eleven', 'twelve', 'n13', 'n14', 'n15', 'n16', 'n17', 'n18', 'n19',
+'n20', or one of 10 others.
+)");
+    EXPECT_PARSE(cli, "-n n30 -n twelve");
+    EXPECT(nums.size() == 2 && nums[0] == 30 && nums[1] == 12);
+    EXPECT_PARSE(cli, "-n TWELVE", false);
+
+    // case insensitive and prefix matching
+    cli = {};
+    auto & lvl = cli.opt<int>("l").choiceFlags(cli.fChoicePrefix)
+        .choice(1, "info").choice(2, "in").choice(3, "warn")
+        .choice(4, "warning").choice(5, "error");
+    EXPECT_PARSE(cli, "-l e");
+    EXPECT(*lvl == 5);
+    EXPECT_PARSE(cli, "-l in");
+    EXPECT(*lvl == 2);
+    EXPECT_PARSE(cli, "-l inf");
+    EXPECT(*lvl == 1);
+    EXPECT_PARSE(cli, "-l warn");
+    EXPECT(*lvl == 3);
+    EXPECT_PARSE(cli, "-l warni");
+    EXPECT(*lvl == 4);
+    EXPECT_PARSE(cli, "-l Err", false);
+    EXPECT_PARSE(cli, "-l i", false);
+    EXPECT_ERR(cli, 1 + R"(
+Error: Invalid '-l' value: i
+Ambiguous, could be 'in' or 'info'.
+)");
+    EXPECT_PARSE(cli, "-l x", false);
+    EXPECT_ERR(cli, 1 + R"(
+Error: Invalid '-l' value: x
+Must be 'info', 'in', 'warn', 'warning', or 'error'.
+)");
+    lvl.choiceFlags(cli.fChoicePrefix | cli.fChoiceInsensitive);
+    EXPECT_PARSE(cli, "-l Err");
+    EXPECT(*lvl == 5);
+    EXPECT_PARSE(cli, "-l WARN");
+    EXPECT(*lvl == 3);
+    lvl.choice(6, "Warn").choiceFlags(cli.fChoiceInsensitive);
+    EXPECT_PARSE(cli, "-l Warn");
+    EXPECT(*lvl == 6);
+    EXPECT_PARSE(cli, "-l WARN", false);
+    EXPECT_PARSE(cli, "-l ERROR");
+    EXPECT(*lvl == 5);
+    EXPECT_PARSE(cli, "-l err", false);
+
+    // Choices are folded with the locale the option is imbued with.
+    cli = {};
+    auto & pick = cli.opt<int>("p").choice(1, "i").choice(2, "1")
+        .choiceFlags(cli.fChoiceInsensitive);
+    EXPECT_PARSE(cli, "-p I");
+    EXPECT(*pick == 1);
+    pick.imbue(locale(locale::classic(), new OddFolding));
+    EXPECT_PARSE(cli, "-p I");
+    EXPECT(*pick == 2);
 }
 
 
@@ -1225,6 +1613,20 @@ Options:
   --help    Show this message and exit.
 )");
     }
+
+    {
+        // Long names, including "no-" variants, that are declared again by a
+        // later option are taken by it.
+        cli = {};
+        auto & a = cli.opt<bool>("a apple");
+        auto & b = cli.opt<bool>("b no-apple");
+        auto & c = cli.opt<int>("c cherry");
+        auto & d = cli.opt<int>("d cherry");
+        EXPECT_PARSE(cli, "--apple --no-apple --cherry=3");
+        EXPECT(*a && *b && *c == 0 && *d == 3);
+        EXPECT_PARSE(cli, "--no-cherry", false);
+        EXPECT_ERR(cli, "Error: Unknown option: --no-cherry\n");
+    }
 }
 
 
@@ -1669,6 +2071,28 @@ void optCheckTests() {
         EXPECT_ERR(cli, "Error: No value given for --index\n");
     }
 
+    // after
+    {
+        cli = {};
+        string order;
+        cli.opt<bool>("a").after([&](auto &, auto &, auto &) {
+            order += 'a';
+        });
+        cli.opt<bool>("b").command("x")
+            .after([&](auto &, auto &, auto &) { order += 'b'; });
+        auto & c = cli.opt<bool>("c").allCmds(false);
+        cli.command("y");
+        EXPECT_PARSE(cli, "x");
+        EXPECT(order == "ab");
+        c.after([&](auto &, auto &, auto &) { order += 'c'; });
+        order.clear();
+        EXPECT_PARSE(cli, "x");
+        EXPECT(order == "abc");
+        order.clear();
+        EXPECT_PARSE(cli, "y");
+        EXPECT(order == "ac");
+    }
+
     // clamp and range
     {
         cli = {};
@@ -1915,6 +2339,71 @@ void responseTests(const string & rawProgName) {
     }
 #endif
 
+    // list files
+    writeRsp("test/a.lst", "a\nb c\r\n\n\"d\"");
+    writeRsp("test/b.lst", "\xef\xbb\xbf" "b1\nb2\0\0b3\0");
+    writeRsp("test/none.lst", "");
+    writeRsp("test/nums.lst", "1\n2\nx\n");
+    cli = {};
+    auto & files = cli.optVec<string>("[file]").desc("Files to process.")
+        .fromListFile("files-from");
+    EXPECT_PARSE(cli, "x --files-from test/a.lst y");
+    EXPECT(*files == vector<string>{"x", "a", "b c", "\"d\"", "y"});
+    EXPECT(files.from(0) == "file" && files.from(1) == "--files-from");
+    EXPECT(files.pos(1) == 3 && files.pos(3) == 3 && files.pos(4) == 4);
+    EXPECT_PARSE(cli, "--files-from=test/b.lst --files-from test/none.lst");
+    EXPECT(*files == vector<string>{"b1\nb2", "b3"});
+    EXPECT_PARSE(cli, "--files-from test/does_not_exist.lst", false);
+    EXPECT_ERR(cli, 1 + R"(
+Error: Invalid list file: test/does_not_exist.lst
+)");
+    istringstream in("s1\ns2\n");
+    cli.iostreams(&in, nullptr);
+    EXPECT_PARSE(cli, "--files-from - t");
+    EXPECT(*files == vector<string>{"s1", "s2", "t"});
+    EXPECT_HELP(cli, "", 1 + R"(
+Usage: test [OPTIONS] [file...]
+  file      Files to process.
+
+Options:
+  --files-from=FILE  File listing more values, one per line ('-' for stdin).
+
+  --help             Show this message and exit.
+)");
+
+    cli = {};
+    int total = 0;
+    auto & nums = cli.optVec<int>("n").size(0, 4).fromListFile("n-list")
+        .sink([&total](auto &, auto &, int && val) { total += val; });
+    EXPECT_PARSE(cli, "-n5 --n-list test/nums.lst", false);
+    EXPECT_ERR(cli, "Error: Invalid '--n-list' value: x\n");
+    EXPECT(total == 8 && nums.from(2) == "--n-list");
+    EXPECT_PARSE(cli, "-n5 -n6 -n7 --n-list test/nums.lst", false);
+    EXPECT_ERR(cli, 1 + R"(
+Error: Too many '--n-list' values: 2
+The maximum number of values is 4.
+)");
+
+    // The list option follows its target to other commands and groups.
+    cli = {};
+    auto & ids = cli.optVec<int>("id").fromListFile("id-list").command("run");
+    ids.group("Ids");
+    EXPECT_PARSE(cli, "--id-list test/nums.lst", false);
+    EXPECT_ERR(cli, "Error: Unknown option: --id-list\n");
+    EXPECT_PARSE(cli, "run --id-list test/nums.lst", false);
+    EXPECT_ERR(cli, "Error: Command 'run': Invalid '--id-list' value: x\n");
+    EXPECT_HELP(cli, "run", 1 + R"(
+Usage: test run [OPTIONS]
+
+Ids:
+  --id-list=FILE  File listing more values, one per line ('-' for stdin).
+  --id=NUM
+
+  --help          Show this message and exit.
+)");
+
+    for (auto && name : {"a", "b", "none", "nums"})
+        fs::remove("test/"s + name + ".lst", ec);
 #endif
 }
 
@@ -1952,6 +2441,16 @@ Options:
   --help       Show this message and exit.
 )");
     }
+
+    // paths moved from owned arguments
+    {
+        cli = {};
+        auto & paths = cli.optVec<fs::path>("[path]");
+        auto args = vector<string>{"test", "a/b.txt", "c"};
+        EXPECT(cli.parse(move(args)));
+        EXPECT(paths.size() == 2 && paths[0] == "a/b.txt" && paths[1] == "c");
+        EXPECT(args[1].empty() && args[2].empty());
+    }
 #endif
 }
 
@@ -2037,6 +2536,28 @@ void vectorTests() {
     int line = 0;
     CliTest cli;
 
+    // where values came from, as runs of consecutive arguments
+    {
+        cli = {};
+        auto & files = cli.optVec<string>("[file]");
+        auto & incs = cli.optVec<string>("I");
+        auto & verbose = cli.optVec<bool>("v");
+        EXPECT_PARSE(cli, "a b -Ix c -vvv d -Iy -Iz");
+        EXPECT(files.size() == 4 && incs.size() == 3 && verbose.size() == 3);
+        EXPECT(files.from(0) == "file" && files.pos(0) == 1);
+        EXPECT(files.pos(1) == 2 && files.pos(2) == 4 && files.pos(3) == 6);
+        EXPECT(&files.from(0) == &files.from(3));
+        EXPECT(files.from(4) == "" && files.pos(4) == 0);
+        EXPECT(incs.from(2) == "-I" && incs.pos(0) == 3 && incs.pos(2) == 8);
+        EXPECT(verbose.from(1) == "-v" && verbose.pos(2) == 5);
+        vector<string> args = {"test"};
+        for (int i = 0; i < 1000; ++i)
+            args.push_back(to_string(i));
+        EXPECT(cli.parse(args));
+        EXPECT(files.size() == 1000 && files->capacity() >= 1000);
+        EXPECT(files.pos(999) == 1000 && files.from(500) == "file");
+    }
+
     // vector option
     {
         cli = {};
@@ -2109,6 +2630,137 @@ Options:
 )");
     }
 
+    // values streamed to a sink
+    {
+        cli = {};
+        vector<pair<int, int>> got;
+        auto & n = cli.optVec<int>("n").size(2, 3)
+            .check([](auto & cli, auto & opt, auto & val) {
+                if (*opt->rbegin() < 0)
+                    cli.badUsage(opt, val, "Can't be negative.");
+            })
+            .sink([&got](auto & cli, auto & opt, int && val) {
+                if (val == 13)
+                    return cli.badUsage(opt, to_string(val), "Unlucky.");
+                got.push_back({val, opt.pos()});
+            });
+        EXPECT_PARSE(cli, "-n1 -n 2");
+        EXPECT(n.size() == 2 && n->empty());
+        EXPECT(got == (vector<pair<int, int>>{{1, 1}, {2, 3}}));
+        EXPECT(n.from(1) == "-n" && n.pos(1) == 3);
+        got.clear();
+        EXPECT_PARSE(cli, "-n1 -n-2", false);
+        EXPECT_ERR(cli, 1 + R"(
+Error: Invalid '-n' value: -2
+Can't be negative.
+)");
+        EXPECT(got.size() == 1);
+        EXPECT_PARSE(cli, "-n1 -n13", false);
+        EXPECT_ERR(cli, 1 + R"(
+Error: Invalid '-n' value: 13
+Unlucky.
+)");
+        EXPECT_PARSE(cli, "-n1 -nx", false);
+        EXPECT_ERR(cli, "Error: Invalid '-n' value: x\n");
+        EXPECT_PARSE(cli, "-n1", false);
+        EXPECT_ERR(cli, 1 + R"(
+Error: Option '-n' missing value.
+Must have 2 to 3 values.
+)");
+        EXPECT_PARSE(cli, "-n1 -n2 -n3 -n4", false);
+        EXPECT_ERR(cli, 1 + R"(
+Error: Too many '-n' values: 4
+The maximum number of values is 3.
+)");
+
+        cli = {};
+        size_t total = 0;
+        auto & files = cli.optVec<string>("[file]")
+            .sink([&total](auto &, auto &, string && val) {
+                total += val.size();
+            });
+        EXPECT(cli.parse({"test"s, "ab"s, "cde"s}));
+        EXPECT(total == 5 && files.size() == 2 && files->empty());
+    }
+
+    // values converted in parallel
+    {
+        cli = {};
+        auto & nums = cli.optVec<int>("[num]").parallel();
+        auto & ms = cli.optVec<chrono::milliseconds>("t").parallel();
+        cli.opt<int>("n");
+        auto & ws = cli.optVec<string>("w").parallel()
+            .choice("1", "one").choice("2", "two")
+            .choiceFlags(cli.fChoicePrefix);
+        EXPECT_PARSE(cli, "1 -t 2s 3 -w two -t5ms -w one 4");
+        EXPECT(*nums == vector<int>({1, 3, 4}));
+        EXPECT(ms->size() == 2 && ms[0].count() == 2000 && ms[1].count() == 5);
+        EXPECT(*ws == vector<string>({"2", "1"}));
+        EXPECT(nums.pos(2) == 10 && ws.from(1) == "-w");
+
+        // The first invalid value is reported, even if there are later
+        // errors found while parsing.
+        EXPECT_PARSE(cli, "1 -t 2s x -w two -tbad", false);
+        EXPECT_ERR(cli, "Error: Invalid 'num' value: x\n");
+        EXPECT_PARSE(cli, "1 -t 2x 3 -w two -nx", false);
+        EXPECT_ERR(cli, "Error: Invalid '-t' value: 2x\n");
+        EXPECT_PARSE(cli, "-w 3 -tbad", false);
+        EXPECT_ERR(cli, 1 + R"(
+Error: Invalid '-w' value: 3
+Must be 'one' or 'two'.
+)");
+        EXPECT_PARSE(cli, "-w o -t1s");
+        EXPECT(*ws == vector<string>({"1"}) && ms[0].count() == 1000);
+
+        // Enough values to be split between threads, four of them however
+        // many cores there are.
+        cli.maxThreads(4);
+        vector<string> args = {"test"};
+        for (int i = 0; i < 20000; ++i)
+            args.push_back(to_string(i));
+        EXPECT(cli.parse(args));
+        EXPECT(nums.size() == 20000 && nums[12345] == 12345);
+        args[15001] = "y";
+        args[6001] = "x";
+        EXPECT(!cli.parse(args));
+        EXPECT_ERR(cli, "Error: Invalid 'num' value: x\n");
+        cli.maxThreads(1);
+        EXPECT(!cli.parse(args));
+        EXPECT_ERR(cli, "Error: Invalid 'num' value: x\n");
+
+        // Values are converted before the command they came before.
+        cli = {};
+        auto & vals = cli.optVec<int>("v").parallel();
+        cli.opt<int>("n").command("run");
+        EXPECT_PARSE(cli, "-v1 -v2 run -n3");
+        EXPECT(*vals == vector<int>({1, 2}) && cli.commandMatched() == "run");
+        EXPECT_PARSE(cli, "-v1 -vx run -nx", false);
+        EXPECT_ERR(cli, "Error: Invalid '-v' value: x\n");
+        EXPECT(cli.commandMatched().empty());
+
+        // Exceptions thrown while converting are passed on to the caller.
+        cli = {};
+        cli.maxThreads(4);
+        auto & ts = cli.optVec<Thrower>("[t]").parallel();
+        args.resize(1);
+        for (int i = 0; i < 20000; ++i)
+            args.push_back(to_string(i));
+        EXPECT(cli.parse(args) && ts[12345].value == 12345);
+        args[15001] = "100000";
+        string what;
+        try {
+            EXPECT(!cli.parse(args));
+        } catch (const runtime_error & e) {
+            what = e.what();
+        }
+        EXPECT(what == "too big");
+
+        // Unless there's an invalid value in an earlier chunk.
+        args[6001] = "x";
+        EXPECT(!cli.parse(args));
+        EXPECT_ERR(cli, "Error: Invalid 't' value: x\n");
+    }
+
     // optional vector operand with size
     {
         cli = {};
@@ -2409,6 +3061,24 @@ void unitsTests() {
     EXPECT(true);
 #endif
 
+    // imbue
+    {
+        cli = {};
+        auto & opt = cli.opt<int>("n");
+        string str;
+        EXPECT(opt.toString(str, 1'234'567) && str == "1234567");
+        auto prev = opt.imbue(loc);
+        EXPECT(prev == locale());
+        EXPECT(opt.toString(str, 1'234'567) && str == "1,234,567");
+        EXPECT(opt.imbue(prev) == loc);
+        EXPECT(opt.toString(str, 1'234'567) && str == "1234567");
+
+        auto & grp = cli.opt<int>("g");
+        grp.imbue(loc);
+        EXPECT_PARSE(cli, "-g 7,654,321");
+        EXPECT(*grp == 7'654'321);
+    }
+
     // si units
     {
         cli = {};
@@ -2499,6 +3169,8 @@ Must be between '-2,147,483,648' and '2,147,483,647'.
         auto & sd = cli.opt<double>("d").siUnits();
         EXPECT_PARSE(cli, "-d2.k");
         EXPECT(*sd == 2000);
+        EXPECT_PARSE(cli, "-d1.234567891k");
+        EXPECT(*sd == 1234.567891);
 
         EnumAB seRaw;
         auto & se = cli.opt(&seRaw, "e").siUnits();
@@ -2519,6 +3191,29 @@ Options:
 )");
     }
 
+    // integer units
+    {
+        cli = {};
+        auto & sl = cli.opt<int64_t>("l").siUnits();
+        EXPECT_PARSE(cli, "-l9223372036854775807");
+        EXPECT(*sl == numeric_limits<int64_t>::max());
+        EXPECT_PARSE(cli, "-l-9223372036854775808");
+        EXPECT(*sl == numeric_limits<int64_t>::min());
+        EXPECT_PARSE(cli, "-l9007199254740993k");
+        EXPECT(*sl == 9'007'199'254'740'993'000);
+        EXPECT_PARSE(cli, "-l9223372036854776k", false);
+        EXPECT_PARSE(cli, "-l1500m");
+        EXPECT(*sl == 2);
+        auto & su = cli.opt<uint32_t>("u").siUnits("", cli.fUnitBinaryPrefix);
+        EXPECT_PARSE(cli, "-u3Gi");
+        EXPECT(*su == 3u << 30);
+        EXPECT_PARSE(cli, "-u4Gi", false);
+        EXPECT_PARSE(cli, "-u-1k", false);
+        auto & sv = cli.optVec<int>("v").siUnits();
+        EXPECT_PARSE(cli, "-v1k -v2");
+        EXPECT(sv.size() == 2 && sv[0] == 1000 && sv[1] == 2);
+    }
+
     // time units
     {
         cli = {};
@@ -2568,6 +3263,62 @@ Must be between '0' and '65,535'.
 #endif
     }
 
+    // chrono durations
+    {
+        using namespace std::chrono;
+        cli = {};
+        auto & ms = cli.opt<milliseconds>("m", 1500ms);
+        auto & ns = cli.opt<nanoseconds>("n", 2h);
+        auto & secs = cli.opt<duration<double>>("s", 2.5s);
+        auto & tp = cli.opt<time_point<system_clock, seconds>>("t");
+        EXPECT_HELP(cli, "", 1 + R"(
+Usage: test [OPTIONS]
+
+Options:
+  -m DURATION  (default: 1500ms)
+  -n DURATION  (default: 2h)
+  -s DURATION  (default: 2.5s)
+  -t DURATION  (default: 0s)
+
+  --help       Show this message and exit.
+)");
+        EXPECT_PARSE(cli, "-m1h30m -n9007199254740993ns -s100ms -t1d");
+        EXPECT(*ms == 90min);
+        EXPECT(*ns == nanoseconds(9'007'199'254'740'993));
+        EXPECT(*secs == duration<double>(0.1));
+        EXPECT(tp->time_since_epoch() == 24h);
+        EXPECT_PARSE(cli, "-m250 -n-1.5us -s-1m");
+        EXPECT(*ms == 250ms && *ns == -1500ns && *secs == -60s);
+        EXPECT_PARSE(cli, "-m1.0005s -n292y");
+        EXPECT(*ms == 1001ms);
+        EXPECT(*ns == 292 * 365 * 24h);
+        EXPECT_PARSE(cli, "-n293y", false);
+        EXPECT_ERR(cli, "Error: Invalid '-n' value: 293y\n");
+        EXPECT_PARSE(cli, "-n-9223372036854775808");
+        EXPECT(*ns == nanoseconds::min());
+        EXPECT_PARSE(cli, "-n-9223372036854775809", false);
+        EXPECT_PARSE(cli, "-m1h30", false);
+        EXPECT_PARSE(cli, "-m1x", false);
+        EXPECT_PARSE(cli, "-m1H", false);
+        EXPECT_PARSE(cli, "-m.s", false);
+        auto & us = cli.opt<duration<uint32_t, micro>>("u");
+        EXPECT_PARSE(cli, "-u-0s");
+        EXPECT_PARSE(cli, "-u-1s", false);
+        EXPECT_PARSE(cli, "-u2h", false);
+        EXPECT_PARSE(cli, "-u1h11min");
+        EXPECT(*us == 4'260s);
+
+        string out;
+        EXPECT(ms.toString(out, 90s) && out == "90s");
+        EXPECT(ms.toString(out, -3h) && out == "-3h");
+        EXPECT(ms.toString(out, 14 * 24h) && out == "2w");
+        EXPECT(ms.toString(out, duration<int, ratio<1, 3>>(4))
+            && out == "4");
+        EXPECT(ms.toString(out, minutes::zero()) && out == "0min");
+        EXPECT(ms.toString(out, duration<float, milli>(1.5f))
+            && out == "1.5ms");
+    }
+
     // any units
     {
         cli = {};
@@ -2580,6 +3331,29 @@ Must be between '0' and '65,535'.
         EXPECT(*length == 3600);
         EXPECT_PARSE(cli, "-l 3600");
         EXPECT(*length == 3600);
+        EXPECT_PARSE(cli, "-l 1mil");
+        EXPECT(*length == 0.001);
+        EXPECT_PARSE(cli, "-l 1il", false);
+        EXPECT_ERR(cli, 1 + R"(
+Error: Invalid '-l' value: 1il
+Units symbol 'il' not recognized.
+)");
+    }
+
+    // shared unit tables
+    {
+        cli = {};
+        auto & a = cli.opt<int>("a").anyUnits({{"X", 2}, {"x", 3}});
+        auto & b = cli.opt<int>("b").anyUnits({{"x", 3}, {"X", 2}});
+        auto & c = cli.opt<int>("c")
+            .anyUnits({{"X", 2}, {"x", 3}}, cli.fUnitInsensitive);
+        auto & d = cli.optVec<int>("d").timeUnits(cli.fUnitInsensitive);
+        auto & e = cli.opt<int>("e").timeUnits();
+        EXPECT_PARSE(cli, "-a1X -b1X -c1X -d1MIN -d1M -e1min");
+        EXPECT(*a == 2 && *b == 2 && *c == 3);
+        EXPECT(d.size() == 2 && d[0] == 60 && d[1] == 60 && *e == 60);
+        EXPECT_PARSE(cli, "-e1MIN", false);
+        EXPECT_PARSE(cli, "-e1in", false);
     }
 }
 
@@ -14,6 +14,8 @@
 
 #include <iostream>
 #include <chrono>
+#include <cstdio>
+#include <fstream>
 
 #undef NDEBUG
 #include <cassert>
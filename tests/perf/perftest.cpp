@@ -15,6 +15,42 @@ static bool doubleequals(const double a, const double b) {
     return diff < delta && diff > -delta;
 }
 
+//===========================================================================
+// Type that's only parseable through the (relatively slow) istream path.
+struct Color {
+    int r = 0;
+    int g = 0;
+    int b = 0;
+
+    bool operator==(const Color & other) const {
+        return r == other.r && g == other.g && b == other.b;
+    }
+};
+std::istream & operator>>(std::istream & is, Color & out) {
+    char c1 = 0;
+    char c2 = 0;
+    is >> out.r >> c1 >> out.g >> c2 >> out.b;
+    if (c1 != ',' || c2 != ',')
+        is.setstate(std::ios::failbit);
+    return is;
+}
+
+//===========================================================================
+template <typename T>
+static void convertPerf(const char name[], const std::string & value) {
+    Dim::Cli::Convert cvt;
+    auto start = high_resolution_clock::now();
+    T out{};
+    for (int x = 0; x < 1'000'000; ++x) {
+        bool result = cvt.fromString(out, value);
+        assert(result == true);
+        (void) result;
+    }
+    auto runtime = high_resolution_clock::now() - start;
+    std::cout << "dimcli convert " << name << " seconds to run: "
+        << duration_cast<duration<double>>(runtime).count() << std::endl;
+}
+
 //===========================================================================
 int main(int argc, char * argv[]) {
     Dim::Cli cli;
@@ -100,5 +136,304 @@ int main(int argc, char * argv[]) {
             << duration_cast<duration<double>>(runtime).count() << std::endl;
     }
 
+    // dimcli - large schema, with and without reuse of the option index
+    for (auto reindex : {false, true}) {
+        auto start = high_resolution_clock::now();
+        Dim::CliLocal cli;
+        for (int i = 0; i < 200; ++i) {
+            auto name = "opt" + std::to_string(i);
+            cli.opt<int>(name + " o" + std::to_string(i));
+        }
+        auto & last = cli.opt<int>("last");
+        std::vector<std::string> arguments({"progname", "--last", "5"});
+        for (int x = 0; x < 10'000; ++x) {
+            // Changing the visibility of an option discards the index.
+            if (reindex)
+                last.show(x % 2);
+            bool result = cli.parse(arguments);
+            assert(result == true);
+            assert(*last == 5);
+        }
+        auto runtime = high_resolution_clock::now() - start;
+        std::cout << "dimcli " << (reindex ? "reindexed" : "cached")
+            << " schema seconds to run: "
+            << duration_cast<duration<double>>(runtime).count() << std::endl;
+    }
+
+    // dimcli - many subcommands, each with its own options
+    {
+        auto start = high_resolution_clock::now();
+        Dim::CliLocal cli;
+        for (int i = 0; i < 400; ++i) {
+            auto cmd = "cmd" + std::to_string(i);
+            for (int j = 0; j < 15; ++j)
+                cli.opt<int>("opt" + std::to_string(j)).command(cmd);
+        }
+        auto & verbose = cli.opt<bool>("v verbose").allCmds(false);
+        std::vector<std::string> arguments({"progname", "", "-v", "--opt3=1"});
+        for (int x = 0; x < 10'000; ++x) {
+            arguments[1] = "cmd" + std::to_string(x % 400);
+            bool result = cli.parse(arguments);
+            assert(result == true);
+            assert(*verbose);
+        }
+        auto runtime = high_resolution_clock::now() - start;
+        std::cout << "dimcli subcommands seconds to run: "
+            << duration_cast<duration<double>>(runtime).count() << std::endl;
+    }
+
+    // dimcli - conversion of values, by type
+    convertPerf<int>("int", "-123456");
+    convertPerf<unsigned>("unsigned", "123456");
+    convertPerf<long long>("long long", "-1234567890123");
+    convertPerf<float>("float", "3.14159");
+    convertPerf<double>("double", "-2.718281828e10");
+    convertPerf<std::string>("string", "some text");
+
+    // dimcli - many operands, with and without giving up the arguments
+    for (auto owned : {false, true}) {
+        Dim::CliLocal cli;
+        auto & files = cli.optVec<std::string>("[file]");
+        std::vector<std::string> arguments{"progname"};
+        for (int i = 0; i < 200'000; ++i)
+            arguments.push_back("some/directory/file" + std::to_string(i));
+        auto start = high_resolution_clock::now();
+        bool result = owned
+            ? cli.parse(std::move(arguments))
+            : cli.parse(arguments);
+        assert(result == true);
+        assert(files.size() == 200'000);
+        (void) result;
+        auto runtime = high_resolution_clock::now() - start;
+        std::cout << "dimcli " << (owned ? "owned" : "copied")
+            << " operands seconds to run: "
+            << duration_cast<duration<double>>(runtime).count() << std::endl;
+    }
+
+    // dimcli - many operands streamed to a sink instead of kept
+    {
+        Dim::CliLocal cli;
+        size_t total = 0;
+        auto & files = cli.optVec<std::string>("[file]")
+            .sink([&](auto &, auto &, std::string && file) {
+                total += file.size();
+            });
+        std::vector<std::string> arguments{"progname"};
+        for (int i = 0; i < 200'000; ++i)
+            arguments.push_back("some/directory/file" + std::to_string(i));
+        auto start = high_resolution_clock::now();
+        bool result = cli.parse(std::move(arguments));
+        assert(result == true);
+        assert(files.size() == 200'000 && total > 0);
+        (void) result;
+        auto runtime = high_resolution_clock::now() - start;
+        std::cout << "dimcli sink operands seconds to run: "
+            << duration_cast<duration<double>>(runtime).count() << std::endl;
+    }
+
+    // dimcli - many operands from a response file and from a list file
+    {
+        std::ofstream f("perf-files.tmp", std::ios::binary | std::ios::trunc);
+        for (int i = 0; i < 1'000'000; ++i)
+            f << "some/directory/file" << i << '\n';
+    }
+    for (auto list : {false, true}) {
+        Dim::CliLocal cli;
+        auto & files = cli.optVec<std::string>("[file]")
+            .fromListFile("files-from");
+        auto arg = list ? "--files-from=perf-files.tmp" : "@perf-files.tmp";
+        std::vector<std::string> arguments{"progname", arg};
+        auto start = high_resolution_clock::now();
+        bool result = cli.parse(arguments);
+        assert(result == true);
+        assert(files.size() == 1'000'000);
+        (void) result;
+        auto runtime = high_resolution_clock::now() - start;
+        std::cout << "dimcli " << (list ? "list" : "response")
+            << " file operands seconds to run: "
+            << duration_cast<duration<double>>(runtime).count() << std::endl;
+    }
+    std::remove("perf-files.tmp");
+
+    // dimcli - many operands converted one at a time and in parallel
+    for (auto parallel : {false, true}) {
+        Dim::CliLocal cli;
+        auto & nums = cli.optVec<double>("[num]").parallel(parallel);
+        std::vector<std::string> arguments{"progname"};
+        for (int i = 0; i < 200'000; ++i)
+            arguments.push_back(std::to_string(i) + ".25");
+        auto start = high_resolution_clock::now();
+        bool result = cli.parse(arguments);
+        assert(result == true);
+        assert(nums.size() == 200'000 && nums[1] == 1.25);
+        (void) result;
+        auto runtime = high_resolution_clock::now() - start;
+        std::cout << "dimcli " << (parallel ? "parallel" : "serial")
+            << " operands seconds to run: "
+            << duration_cast<duration<double>>(runtime).count() << std::endl;
+    }
+
+    // dimcli - many values, only one of which is read, with and without
+    // lazy conversion
+    for (auto lazy : {false, true}) {
+        Dim::CliLocal cli;
+        cli.lazyValues(lazy);
+        std::vector<std::string> arguments{"progname"};
+        for (int i = 0; i < 500; ++i) {
+            auto name = "opt" + std::to_string(i);
+            cli.opt<Color>(name);
+            arguments.push_back(
+                "--" + name + "=" + std::to_string(i) + ",1,2"
+            );
+        }
+        auto & last = cli.opt<Color>("last");
+        arguments.push_back("--last=3,4,5");
+        auto start = high_resolution_clock::now();
+        for (int x = 0; x < 1'000; ++x) {
+            bool result = cli.parse(arguments);
+            assert(result == true);
+            assert(last->b == 5);
+            (void) result;
+        }
+        auto runtime = high_resolution_clock::now() - start;
+        std::cout << "dimcli " << (lazy ? "lazy" : "eager")
+            << " values seconds to run: "
+            << duration_cast<duration<double>>(runtime).count() << std::endl;
+    }
+
+    // dimcli - values with unit suffixes
+    {
+        Dim::CliLocal cli;
+        auto & sizes = cli.optVec<uint64_t>("[size]").siUnits("B");
+        std::vector<std::string> arguments{"progname"};
+        for (int i = 0; i < 1'000; ++i)
+            arguments.push_back(std::to_string(i) + "kB");
+        auto start = high_resolution_clock::now();
+        for (int x = 0; x < 100; ++x) {
+            bool result = cli.parse(arguments);
+            assert(result == true);
+            assert(sizes[999] == 999'000);
+            (void) result;
+        }
+        auto runtime = high_resolution_clock::now() - start;
+        std::cout << "dimcli units seconds to run: "
+            << duration_cast<duration<double>>(runtime).count() << std::endl;
+    }
+
+    // dimcli - range list selecting many values
+    {
+        Dim::CliLocal cli;
+        auto & shards = cli.opt<Dim::Cli::RangeList<int>>("shards");
+        std::vector<std::string> arguments{
+            "progname",
+            "--shards=0-99999,150000-199999"
+        };
+        auto start = high_resolution_clock::now();
+        size_t found = 0;
+        for (int x = 0; x < 1'000; ++x) {
+            bool result = cli.parse(arguments);
+            assert(result == true);
+            (void) result;
+            for (int i = 0; i < 1'000; ++i)
+                found += shards->contains(i * 200);
+        }
+        assert(shards->size() == 150'000 && found == 750'000);
+        auto runtime = high_resolution_clock::now() - start;
+        std::cout << "dimcli range list seconds to run: "
+            << duration_cast<duration<double>>(runtime).count() << std::endl;
+    }
+
+    // dimcli - registration of many options
+    {
+        auto start = high_resolution_clock::now();
+        for (int x = 0; x < 10; ++x) {
+            Dim::CliLocal cli;
+            for (int i = 0; i < 6'000; ++i)
+                cli.opt<int>("opt" + std::to_string(i));
+        }
+        auto runtime = high_resolution_clock::now() - start;
+        std::cout << "dimcli registration seconds to run: "
+            << duration_cast<duration<double>>(runtime).count() << std::endl;
+    }
+
+    // dimcli - values matched with many choices
+    {
+        Dim::CliLocal cli;
+        auto & regions = cli.optVec<int>("[region]")
+            .choiceFlags(cli.fChoicePrefix);
+        for (int i = 0; i < 20'000; ++i)
+            regions.choice(i, "region-" + std::to_string(i) + "-x");
+        std::vector<std::string> arguments{"progname"};
+        for (int i = 0; i < 1'000; ++i)
+            arguments.push_back("region-" + std::to_string(i * 20) + "-");
+        auto start = high_resolution_clock::now();
+        for (int x = 0; x < 100; ++x) {
+            bool result = cli.parse(arguments);
+            assert(result == true);
+            assert(regions[999] == 19'980);
+            (void) result;
+        }
+        auto runtime = high_resolution_clock::now() - start;
+        std::cout << "dimcli choices seconds to run: "
+            << duration_cast<duration<double>>(runtime).count() << std::endl;
+    }
+
+    // dimcli - registration of many options with units
+    {
+        auto start = high_resolution_clock::now();
+        for (int x = 0; x < 10; ++x) {
+            Dim::CliLocal cli;
+            for (int i = 0; i < 1'000; ++i) {
+                cli.opt<uint64_t>("size" + std::to_string(i)).siUnits("B");
+                cli.opt<double>("time" + std::to_string(i)).timeUnits();
+            }
+        }
+        auto runtime = high_resolution_clock::now() - start;
+        std::cout << "dimcli units registration seconds to run: "
+            << duration_cast<duration<double>>(runtime).count() << std::endl;
+    }
+
+    // dimcli - help text with many numeric defaults
+    {
+        auto start = high_resolution_clock::now();
+        Dim::CliLocal cli;
+        for (int i = 0; i < 200; ++i) {
+            auto name = std::to_string(i);
+            cli.opt<int>("i" + name, i * 1'000).desc("Integer.");
+            cli.opt<double>("d" + name, i / 7.0).desc("Double.");
+        }
+        std::ostringstream os;
+        for (int x = 0; x < 20; ++x) {
+            os.str({});
+            cli.printHelp(os);
+        }
+        auto runtime = high_resolution_clock::now() - start;
+        std::cout << "dimcli numeric defaults seconds to run: "
+            << duration_cast<duration<double>>(runtime).count() << std::endl;
+    }
+
+    // dimcli - clusters of short flags
+    {
+        auto start = high_resolution_clock::now();
+        Dim::CliLocal cli;
+        auto & x = cli.opt<bool>("x");
+        auto & v = cli.opt<bool>("v");
+        auto & z = cli.opt<bool>("z");
+        auto & f = cli.opt<std::string>("f");
+        std::vector<std::string> arguments({"progname"});
+        for (int i = 0; i < 1000; ++i)
+            arguments.push_back("-xvzxvzxvzxvz");
+        arguments.push_back("-xvzfout.tar");
+        for (int n = 0; n < 100; ++n) {
+            bool result = cli.parse(arguments);
+            assert(result == true);
+            assert(*x && *v && *z);
+            assert(*f == "out.tar");
+        }
+        auto runtime = high_resolution_clock::now() - start;
+        std::cout << "dimcli short flags seconds to run: "
+            << duration_cast<duration<double>>(runtime).count() << std::endl;
+    }
+
     return 0;
 }